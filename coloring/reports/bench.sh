@@ -0,0 +1,51 @@
+# This script runs the benchmark matrix configured in bench.conf, generating
+# an output file with one line per algorithm and instance: number of vertices,
+# number of edges, best k, mean k, mean time in seconds, local search
+# iterations per second and number of runs without a feasible solution.
+# If a baseline report is given, the results are compared against it.
+if [ $# -gt 2 ]; then echo 1>&2 Usage: $0 [BASELINE_REPORT [THRESHOLD_PERCENT]]; exit 1; fi
+TIMESTAMP=`date +%Y-%m-%d_%Hh%M`
+OUTPUT=bench_output_${TIMESTAMP}.txt
+. ./bench.conf
+cd ../instances/
+FILES=""
+for instance in ${INSTANCES}; do FILES="${FILES} ${instance}.col"; done
+for seed in ${SEEDS}
+do ../debug/coloring -b -j 1 -s ${seed} ${ALGORITHMS} ${FILES}
+done | awk -F '\t' '
+    NF < 11 {
+        # Feasible solution not found
+        split($1, name, " ")
+        key = $NF "\t" name[1]
+        failures[key]++
+        keys[key] = 1
+        next
+    }
+    {
+        # The algorithm is in the last column
+        key = $NF "\t" $1
+        keys[key] = 1
+        size[key] = $2 "\t" $3
+        if (!(key in best) || $4 < best[key]) best[key] = $4
+        sumK[key] += $4
+        sumTime[key] += $7 + $8
+        sumSearch[key] += $8
+        sumIterations[key] += $9
+        runs[key]++
+    }
+    END {
+        OFS = "\t"
+        for (key in keys) {
+            if (runs[key] == 0) {
+                print key, "-", "-", "-", "-", "-", "-", failures[key] + 0
+                continue
+            }
+            ips = (sumSearch[key] > 0) ? sumIterations[key] / (sumSearch[key] / 1e9) : 0
+            print key, size[key], best[key], sprintf("%.2f", sumK[key] / runs[key]),
+                    sprintf("%.4f", sumTime[key] / runs[key] / 1e9),
+                    sprintf("%.0f", ips), failures[key] + 0
+        }
+    }' | sort > ../reports/${OUTPUT}
+cd ../reports/
+echo "Results written to ${OUTPUT}"
+if [ $# -ge 1 ]; then sh compare.sh $1 ${OUTPUT} $2; fi
@@ -0,0 +1,59 @@
+# This script compares a benchmark output file against a baseline, which may
+# be another benchmark output file or a report written by report.sh (in which
+# case the algorithm is taken from the file name). Mean k and mean time that
+# grow beyond the threshold percentage (default: 10) are flagged, and the
+# script exits with status 1 if any regression is found.
+if [ $# -lt 2 ] || [ $# -gt 3 ]; then echo 1>&2 Usage: $0 BASELINE_REPORT BENCH_OUTPUT [THRESHOLD_PERCENT]; exit 1; fi
+THRESHOLD=${3:-10}
+case `basename $1` in
+    bench_output_*) ALGORITHM="" ;;
+    *_output_*) ALGORITHM=`basename $1 | sed 's/_output_.*//'` ;;
+    *) ALGORITHM="" ;;
+esac
+awk -F '\t' -v algorithm="${ALGORITHM}" -v threshold="${THRESHOLD}" '
+    { sub(/\r$/, "") }
+    FNR == NR {
+        if (algorithm != "") {
+            # Report line: instance, vertices, edges, k, whole seconds
+            if (NF < 5) next
+            key = algorithm "\t" $1
+            baseK[key] = $4
+            baseTime[key] = $5
+            # Reported times are truncated to whole seconds
+            slack[key] = 1
+        } else {
+            if (NF < 9 || $5 == "-") next
+            key = $1 "\t" $2
+            baseK[key] = $6
+            baseTime[key] = $7
+            slack[key] = 0.001
+        }
+        next
+    }
+    {
+        key = $1 "\t" $2
+        if (!(key in baseK)) next
+        compared++
+        if ($5 == "-") {
+            print "NOT_FEASIBLE\t" key
+            regressions++
+            next
+        }
+        limit = 1 + threshold / 100
+        if ($6 > baseK[key] * limit) {
+            print "WORSE_K\t" key "\t" baseK[key] "\t" $6
+            regressions++
+        } else if ($6 < baseK[key]) {
+            print "BETTER_K\t" key "\t" baseK[key] "\t" $6
+        }
+        if ($7 > baseTime[key] * limit + slack[key]) {
+            print "SLOWER\t" key "\t" baseTime[key] "\t" $7
+            regressions++
+        } else if ($7 * limit + slack[key] < baseTime[key]) {
+            print "FASTER\t" key "\t" baseTime[key] "\t" $7
+        }
+    }
+    END {
+        print compared + 0 " compared, " regressions + 0 " regressions (threshold " threshold "%)"
+        exit (regressions > 0)
+    }' $1 $2
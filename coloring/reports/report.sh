@@ -3,6 +3,6 @@
 if [ $# -ne 1 ]; then echo 1>&2 Usage: $0 ALGORITHM_NAME; exit; fi
 TIMESTAMP=`date +%Y-%m-%d_%Hh%M`
 cd ../instances/
-for file in *.col
-do ../debug/coloring ${1} ${file}
-done > ../reports/${1}_output_${TIMESTAMP}.txt
\ No newline at end of file
+# Batch lines come in the order the instances finish, so sort them by
+# instance name
+../debug/coloring -b ${1} *.col | sort > ../reports/${1}_output_${TIMESTAMP}.txt
@@ -5,6 +5,6 @@ TIMESTAMP=`date +%Y-%m-%d_%Hh%M`
 cd ../debug/
 make
 cd ../instances/
-for file in *.col
-do ../debug/coloring ${1} ${file}
-done
\ No newline at end of file
+# Instances are colored concurrently, and each line is printed as soon as its
+# instance is finished, with the algorithm name in the last column
+../debug/coloring -b ${1} *.col
@@ -0,0 +1,18 @@
+# This script generates G(n, p) graphs of growing size with colgen and runs
+# the specified coloring algorithms over them, generating an output file with
+# the results, to measure how each algorithm scales with n and density.
+if [ $# -lt 3 ]; then echo 1>&2 Usage: $0 ALGORITHM_NAME[,ALGORITHM_NAME...] DENSITY NUM_VERTICES...; exit 1; fi
+TIMESTAMP=`date +%Y-%m-%d_%Hh%M`
+ALGORITHMS=$1
+DENSITY=$2
+shift 2
+mkdir -p ../instances/generated/
+cd ../instances/generated/
+FILES=""
+for n in $@
+do
+    FILE=gnp_${n}_${DENSITY}.col
+    if [ ! -f ${FILE} ]; then ../../debug/colgen gnp ${n} ${DENSITY} 1 > ${FILE}; fi
+    FILES="${FILES} ${FILE}"
+done
+../../debug/coloring -b -j 1 ${ALGORITHMS} ${FILES} > ../../reports/scaling_output_${TIMESTAMP}.txt
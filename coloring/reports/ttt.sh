@@ -0,0 +1,38 @@
+# This script turns traces written with the -t option of the coloring driver
+# into time-to-target statistics. Each run in each trace file reaches a
+# target k when it first finds a k-coloring without conflicts. For each k,
+# the output gives the number of runs that reached it out of the total, and
+# the minimum, mean, median and maximum time in seconds to reach it.
+if [ $# -lt 1 ]; then echo 1>&2 Usage: $0 TRACE_FILE...; exit 1; fi
+printf "k\truns\tmin\tmean\tmedian\tmax\n"
+awk -F ',' '
+    FNR == 1 || /^#/ { next }
+    {
+        run = FILENAME ":" $1
+        runs[run] = 1
+        key = run SUBSEP $4
+        if ($5 == 0 && !(key in reached)) {
+            reached[key] = $2 / 1e9
+            targets[$4] = 1
+        }
+    }
+    END {
+        for (run in runs) numRuns++
+        for (k in targets) {
+            n = 0
+            sum = 0
+            for (run in runs) {
+                if ((run SUBSEP k) in reached) times[++n] = reached[run SUBSEP k]
+            }
+            # Insertion sort, since there are few runs
+            for (i = 2; i <= n; i++) {
+                t = times[i]
+                for (j = i - 1; j >= 1 && times[j] > t; j--) times[j + 1] = times[j]
+                times[j + 1] = t
+            }
+            for (i = 1; i <= n; i++) sum += times[i]
+            median = (n % 2) ? times[(n + 1) / 2] : (times[n / 2] + times[n / 2 + 1]) / 2
+            printf "%d\t%d/%d\t%.4f\t%.4f\t%.4f\t%.4f\n", k, n, numRuns,
+                    times[1], sum / n, median, times[n]
+        }
+    }' "$@" | sort -k1,1nr
@@ -0,0 +1,112 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdlib>
+
+#include "coloring.h"
+#include "compressed.h"
+#include "timing.h"
+
+/**
+ * Measures how fast adjacency lists are read from plain CSR arrays and from
+ * their compressed form, with the scalar and the SIMD decoders. Each reader
+ * sums all neighbor ids over the given number of passes.
+ */
+
+typedef void (*Decoder)(const unsigned char* in, int count, int* out);
+
+/**
+ * Prints the rate of one reader in millions of neighbors per second.
+ */
+void printRate(const char* name, long long neighbors, long long elapsed,
+        long long checksum)
+{
+    std::cout << name << "\t" << (neighbors * 1000.0 / elapsed) << " M/s\t"
+            << "checksum " << checksum << std::endl;
+}
+
+long long readCompressed(const CompressedAdjacency& compressed, int numVertices,
+        Decoder decoder, std::vector<int>& buffer)
+{
+    long long sum = 0;
+    for (int u = 0; u < numVertices; ++u)
+    {
+        int degree = compressed.degrees[u];
+        decoder(&compressed.bytes[compressed.offsets[u]], degree, &buffer[0]);
+        for (int i = 0; i < degree; ++i) sum += buffer[i];
+    }
+    return sum;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " INSTANCE_FILE [PASSES]" << std::endl;
+        return 1;
+    }
+    int passes = (argc > 2) ? std::max(1, atoi(argv[2])) : 10;
+
+    std::ifstream in(argv[1]);
+    if (!in.is_open())
+    {
+        std::cerr << "Could not open instance file: " << argv[1] << std::endl;
+        return 1;
+    }
+    Instance instance(in);
+    int n = instance.nvertices;
+
+    // Plain CSR arrays and the compressed lists, both sorted
+    std::vector<int> offsets(n + 1, 0);
+    std::vector<int> targets;
+    CompressedAdjacency compressed;
+    int maxDegree = 0;
+    for (int u = 0; u < n; ++u)
+    {
+        int* adj = instance.gamma[u];
+        compressed.append(adj + 1, adj[0]);
+        targets.insert(targets.end(), adj + 1, adj + 1 + adj[0]);
+        offsets[u + 1] = targets.size();
+        maxDegree = std::max(maxDegree, adj[0]);
+    }
+    compressed.finish();
+
+    long long neighbors = (long long) targets.size() * passes;
+    std::cout << "vertices " << n << ", neighbors " << targets.size() << std::endl;
+    std::cout << "csr bytes\t" << (targets.size() + offsets.size()) * sizeof(int) << std::endl;
+    std::cout << "compressed bytes\t" << compressed.size() << "\t"
+            << (double) compressed.bytes.size() / std::max((size_t) 1, targets.size())
+            << " per neighbor" << std::endl;
+
+    long long start = timing_now();
+    long long checksum = 0;
+    for (int p = 0; p < passes; ++p)
+    {
+        for (int u = 0; u < n; ++u)
+        {
+            for (int e = offsets[u]; e < offsets[u + 1]; ++e) checksum += targets[e];
+        }
+    }
+    printRate("csr", neighbors, timing_now() - start, checksum);
+
+    std::vector<int> buffer(maxDegree + 1);
+    start = timing_now();
+    checksum = 0;
+    for (int p = 0; p < passes; ++p)
+        checksum += readCompressed(compressed, n, compressed_decodeScalar, buffer);
+    printRate("scalar", neighbors, timing_now() - start, checksum);
+
+    if (compressed_simdAvailable())
+    {
+        start = timing_now();
+        checksum = 0;
+        for (int p = 0; p < passes; ++p)
+            checksum += readCompressed(compressed, n, compressed_decode, buffer);
+        printRate("simd", neighbors, timing_now() - start, checksum);
+    }
+    else
+    {
+        std::cout << "simd\tnot available" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,350 @@
+#include "autoselect.h"
+#include "ts.h"
+#include "rlf.h"
+#include "dsatur.h"
+#include "components.h"
+#include "timing.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+// Largest graphs colored with tabu search, with RLF and with DSATUR; bigger
+// graphs are colored in the smallest-last order. On sparse graphs of 3000 to
+// 50000 vertices, RLF used as few colors as the multilevel scheme or fewer in
+// all but one case, in a tenth of the time, so the latter is not chosen
+#define TS_MAX_VERTICES 2000
+#define RLF_MAX_VERTICES 20000
+#define DSATUR_MAX_VERTICES 50000
+
+// Adjacency entries above which RLF reads compressed lists
+#define COMPRESS_MIN_ENTRIES 32000000LL
+
+// Vertices of the densest core from which cliques are grown
+#define CLIQUE_STARTS 64
+
+// Threads for coloring the components of the graph
+int autoselectThreads = 1;
+
+void autoselect_setNumThreads(int numThreads)
+{
+    autoselectThreads = std::max(1, numThreads);
+}
+
+/**
+ * Statistics of a graph that are cheap to compute, taken before choosing
+ * how to color it.
+ */
+struct GraphStats
+{
+    double density;
+    int minDegree;
+    int maxDegree;
+    double meanDegree;
+    double degreeDeviation;
+    int numComponents;
+    int largestComponent;
+    int degeneracy;
+    int cliqueSize;
+
+    // Vertices in the order they are removed by repeatedly taking one of
+    // minimum degree, and the position of each vertex in it
+    std::vector<int> removalOrder;
+    std::vector<int> removalPosition;
+};
+
+void computeDegreeStats(const Instance* instance, GraphStats& stats)
+{
+    int n = instance->nvertices;
+    double sum = 0.0, sumSquares = 0.0;
+    stats.minDegree = (n > 0) ? instance->gamma[0][0] : 0;
+    stats.maxDegree = 0;
+    for (int u = 0; u < n; ++u)
+    {
+        int degree = instance->gamma[u][0];
+        stats.minDegree = std::min(stats.minDegree, degree);
+        stats.maxDegree = std::max(stats.maxDegree, degree);
+        sum += degree;
+        sumSquares += (double) degree * degree;
+    }
+    stats.meanDegree = (n > 0) ? sum / n : 0.0;
+    stats.degreeDeviation = (n > 0)
+            ? sqrt(std::max(0.0, sumSquares / n - stats.meanDegree * stats.meanDegree))
+            : 0.0;
+    stats.density = (n > 1) ? sum / ((double) n * (n - 1)) : 0.0;
+}
+
+void computeComponents(const Instance* instance, GraphStats& stats)
+{
+    int n = instance->nvertices;
+    std::vector<char> visited(n, 0);
+    std::vector<int> queue;
+    stats.numComponents = 0;
+    stats.largestComponent = 0;
+    for (int s = 0; s < n; ++s)
+    {
+        if (visited[s]) continue;
+        stats.numComponents++;
+        queue.clear();
+        queue.push_back(s);
+        visited[s] = 1;
+        for (unsigned int head = 0; head < queue.size(); ++head)
+        {
+            int* adj = instance->gamma[queue[head]];
+            for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+            {
+                if (!visited[*it])
+                {
+                    visited[*it] = 1;
+                    queue.push_back(*it);
+                }
+            }
+        }
+        stats.largestComponent = std::max(stats.largestComponent, (int) queue.size());
+    }
+}
+
+/**
+ * Removes a vertex of minimum degree at a time (Batagelj and Zaversnik),
+ * keeping the remaining vertices sorted by their degree among the remaining
+ * ones. The degeneracy is the largest of the degrees at removal.
+ */
+void computeDegeneracy(const Instance* instance, GraphStats& stats)
+{
+    int n = instance->nvertices;
+    std::vector<int> degree(n);
+    std::vector<int> bucketStart(stats.maxDegree + 1, 0);
+    for (int u = 0; u < n; ++u)
+    {
+        degree[u] = instance->gamma[u][0];
+        bucketStart[degree[u]]++;
+    }
+    for (int d = 0, start = 0; d <= stats.maxDegree; ++d)
+    {
+        int size = bucketStart[d];
+        bucketStart[d] = start;
+        start += size;
+    }
+
+    std::vector<int>& sorted = stats.removalOrder;
+    std::vector<int>& position = stats.removalPosition;
+    sorted.resize(n);
+    position.resize(n);
+    for (int u = 0; u < n; ++u)
+    {
+        position[u] = bucketStart[degree[u]]++;
+        sorted[position[u]] = u;
+    }
+    for (int d = stats.maxDegree; d > 0; --d)
+        bucketStart[d] = bucketStart[d - 1];
+    if (stats.maxDegree >= 0) bucketStart[0] = 0;
+
+    stats.degeneracy = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        int u = sorted[i];
+        stats.degeneracy = std::max(stats.degeneracy, degree[u]);
+
+        // Each remaining neighbor of higher degree moves to the start of its
+        // bucket, which then begins one position later, and drops to the
+        // bucket below
+        int* adj = instance->gamma[u];
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            int v = *it;
+            if (degree[v] <= degree[u]) continue;
+            int first = bucketStart[degree[v]];
+            int w = sorted[first];
+            if (w != v)
+            {
+                std::swap(sorted[first], sorted[position[v]]);
+                position[w] = position[v];
+                position[v] = first;
+            }
+            bucketStart[degree[v]]++;
+            degree[v]--;
+        }
+    }
+}
+
+/**
+ * Orders vertices removed later first.
+ */
+struct RemovedLater
+{
+    const std::vector<int>& position;
+
+    RemovedLater(const GraphStats& stats) : position(stats.removalPosition) {}
+
+    bool operator()(int u, int v) const
+    {
+        return position[u] > position[v];
+    }
+};
+
+/**
+ * Grows cliques greedily from the vertices removed last, which lie in the
+ * densest core, adding neighbors in reverse removal order whenever they are
+ * adjacent to the whole clique. Gives the size of the biggest one found.
+ */
+void estimateClique(const Instance* instance, GraphStats& stats)
+{
+    int n = instance->nvertices;
+    std::vector<int> adjacentMembers(n, 0);
+    std::vector<int> touched;
+    std::vector<int> candidates;
+    stats.cliqueSize = (n > 0) ? 1 : 0;
+
+    for (int i = n - 1; i >= std::max(0, n - CLIQUE_STARTS); --i)
+    {
+        int start = stats.removalOrder[i];
+        int* adj = instance->gamma[start];
+        if (adj[0] + 1 <= stats.cliqueSize) continue;
+
+        candidates.assign(adj + 1, adj + 1 + adj[0]);
+        std::sort(candidates.begin(), candidates.end(), RemovedLater(stats));
+
+        int size = 0;
+        touched.clear();
+        for (int c = -1; c < (int) candidates.size(); ++c)
+        {
+            int u = (c == -1) ? start : candidates[c];
+            if (adjacentMembers[u] != size) continue;
+
+            // Add u to the clique
+            size++;
+            int* uAdj = instance->gamma[u];
+            for (int *it = (uAdj + 1), *end = (it + uAdj[0]); it != end; ++it)
+            {
+                if (adjacentMembers[*it]++ == 0) touched.push_back(*it);
+            }
+        }
+        for (unsigned int t = 0; t < touched.size(); ++t)
+            adjacentMembers[touched[t]] = 0;
+        stats.cliqueSize = std::max(stats.cliqueSize, size);
+    }
+}
+
+/**
+ * Colors the vertices greedily in the reverse of their removal order, so
+ * that each one has at most degeneracy colored neighbors and at most
+ * degeneracy + 1 colors are used.
+ */
+void colorSmallestLast(Instance* instance, Solution* solution,
+        const GraphStats& stats)
+{
+    PhaseStart phase;
+    timing_beginPhase(phase);
+
+    int n = instance->nvertices;
+    std::vector<int> usedBy(stats.degeneracy + 2, -1);
+    for (int i = n - 1; i >= 0; --i)
+    {
+        int u = stats.removalOrder[i];
+        int* adj = instance->gamma[u];
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            int color = solution->coloring[*it];
+            if (color != -1 && color < (int) usedBy.size()) usedBy[color] = u;
+        }
+        int color = 0;
+        while (usedBy[color] == u) ++color;
+        solution->coloring[u] = color;
+    }
+
+    timing_addConstruction(phase);
+}
+
+// Algorithms the instance may be colored with
+enum Choice { SMALLEST_LAST, TS_PER_COMPONENT, TS, RLF, DSATUR };
+
+/**
+ * Colors the instance with the algorithm that suits it, judging from its
+ * statistics, and first writes the statistics and the decision to stderr:
+ * - when the degeneracy bound meets the clique found, the smallest-last
+ *   order gives an optimal coloring;
+ * - small graphs get tabu search, per component if there are several;
+ * - medium graphs get RLF, and bigger ones DSATUR, which is faster;
+ * - the biggest graphs get the smallest-last order, which is linear.
+ * RLF reads compressed adjacency lists when they would be big.
+ */
+void autoselect_constructSolution(Instance* instance, Solution* solution)
+{
+    for (int u = 0; u < instance->nvertices; ++u) solution->coloring[u] = -1;
+
+    GraphStats stats;
+    computeDegreeStats(instance, stats);
+    computeComponents(instance, stats);
+    computeDegeneracy(instance, stats);
+    estimateClique(instance, stats);
+
+    int n = instance->nvertices;
+    long long entries = 2LL * instance->nedges;
+    Choice choice;
+    std::string decision;
+    if (stats.cliqueSize == stats.degeneracy + 1)
+    {
+        choice = SMALLEST_LAST;
+        decision = "smallest-last (optimal)";
+    }
+    else if (n <= TS_MAX_VERTICES && stats.numComponents > 1)
+    {
+        choice = TS_PER_COMPONENT;
+        decision = "ts per component";
+    }
+    else if (n <= TS_MAX_VERTICES)
+    {
+        choice = TS;
+        decision = "ts";
+    }
+    else if (n <= RLF_MAX_VERTICES)
+    {
+        choice = RLF;
+        decision = "rlf";
+        if (entries >= COMPRESS_MIN_ENTRIES)
+            decision += " on compressed adjacency";
+    }
+    else if (n <= DSATUR_MAX_VERTICES)
+    {
+        choice = DSATUR;
+        decision = "dsatur";
+    }
+    else
+    {
+        choice = SMALLEST_LAST;
+        decision = "smallest-last";
+    }
+
+    // Written before coloring, which may take long
+    std::ostringstream line;
+    line << "auto: " << n << " vertices, density " << stats.density
+            << ", degrees " << stats.minDegree << ".." << stats.maxDegree
+            << " (mean " << stats.meanDegree << ", deviation "
+            << stats.degreeDeviation << "), " << stats.numComponents
+            << " components (largest " << stats.largestComponent
+            << "), degeneracy " << stats.degeneracy << ", clique "
+            << stats.cliqueSize << " -> " << decision << std::endl;
+    std::cerr << line.str();
+
+    switch (choice)
+    {
+    case SMALLEST_LAST:
+        colorSmallestLast(instance, solution, stats);
+        break;
+    case TS_PER_COMPONENT:
+        components_constructSolution(instance, solution, ts_constructSolution,
+                autoselectThreads, false);
+        break;
+    case TS:
+        ts_constructSolution(instance, solution);
+        break;
+    case RLF:
+        if (entries >= COMPRESS_MIN_ENTRIES) instance->compress();
+        rlf_constructSolution(instance, solution);
+        break;
+    case DSATUR:
+        dsatur_constructSolution(instance, solution);
+        break;
+    }
+}
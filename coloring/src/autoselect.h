@@ -0,0 +1,10 @@
+#ifndef AUTOSELECT_H_
+#define AUTOSELECT_H_
+
+#include "coloring.h"
+
+void autoselect_constructSolution(Instance* instance, Solution* solution);
+
+void autoselect_setNumThreads(int numThreads);
+
+#endif /*AUTOSELECT_H_*/
@@ -0,0 +1,216 @@
+#include "checkpoint.h"
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#define CHECKPOINT_MAGIC "TSCK"
+#define CHECKPOINT_VERSION 2
+
+TsCheckpoint::TsCheckpoint() :
+    nvertices(0), nedges(0), k(0), iteration(0), lastImprovementIteration(0),
+    randomState(0), tenureFactor(1.0)
+{
+}
+
+template <typename T>
+void writeValue(std::ostream& out, T value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::istream& in, T& value)
+{
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return in.good();
+}
+
+/**
+ * Writes a coloring with two bytes per vertex when all its colors fit, and
+ * four otherwise. The width comes first.
+ */
+void writeColoring(std::ostream& out, const std::vector<int>& coloring)
+{
+    int maxColor = coloring.empty() ? 0 : *std::max_element(coloring.begin(), coloring.end());
+    unsigned char width = (maxColor < 65536) ? 2 : 4;
+    writeValue(out, width);
+    for (unsigned int i = 0; i < coloring.size(); ++i)
+    {
+        if (width == 2)
+            writeValue(out, (unsigned short) coloring[i]);
+        else
+            writeValue(out, coloring[i]);
+    }
+}
+
+bool readColoring(std::istream& in, std::vector<int>& coloring, int nvertices)
+{
+    unsigned char width;
+    if (!readValue(in, width) || (width != 2 && width != 4)) return false;
+    coloring.resize(nvertices);
+    for (int i = 0; i < nvertices; ++i)
+    {
+        if (width == 2)
+        {
+            unsigned short color;
+            if (!readValue(in, color)) return false;
+            coloring[i] = color;
+        }
+        else if (!readValue(in, coloring[i]) || coloring[i] < 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Writes the checkpoint to a temporary file that then replaces the given
+ * one, so that an interrupted write leaves the previous checkpoint intact.
+ */
+bool checkpoint_write(const std::string& fileName, const TsCheckpoint& checkpoint)
+{
+    std::string tempName = fileName + ".tmp";
+    {
+        std::ofstream out(tempName.c_str(), std::ofstream::out | std::ofstream::binary);
+        if (!out.is_open()) return false;
+
+        out.write(CHECKPOINT_MAGIC, 4);
+        writeValue(out, (int) CHECKPOINT_VERSION);
+        writeValue(out, checkpoint.nvertices);
+        writeValue(out, checkpoint.nedges);
+        writeColoring(out, checkpoint.feasibleColoring);
+
+        writeValue(out, checkpoint.k);
+        if (checkpoint.k > 0)
+        {
+            writeValue(out, checkpoint.iteration);
+            writeValue(out, checkpoint.lastImprovementIteration);
+            writeValue(out, checkpoint.randomState);
+            writeValue(out, checkpoint.tenureFactor);
+            writeColoring(out, checkpoint.currentColoring);
+            writeColoring(out, checkpoint.bestColoring);
+            writeValue(out, (int) checkpoint.tabuList.size());
+            for (unsigned int i = 0; i < checkpoint.tabuList.size(); ++i)
+            {
+                writeValue(out, checkpoint.tabuList[i].first);
+                writeValue(out, checkpoint.tabuList[i].second);
+            }
+        }
+        out.close();
+        if (out.fail()) return false;
+    }
+    return rename(tempName.c_str(), fileName.c_str()) == 0;
+}
+
+/**
+ * Reads a checkpoint, returning false if the file is not one.
+ */
+bool checkpoint_read(const std::string& fileName, TsCheckpoint& checkpoint)
+{
+    std::ifstream in(fileName.c_str(), std::ifstream::in | std::ifstream::binary);
+    char magic[4];
+    int version;
+    in.read(magic, 4);
+    if (!in.good() || memcmp(magic, CHECKPOINT_MAGIC, 4) != 0) return false;
+    if (!readValue(in, version) || version != CHECKPOINT_VERSION) return false;
+
+    if (!readValue(in, checkpoint.nvertices) || checkpoint.nvertices < 0
+            || !readValue(in, checkpoint.nedges)
+            || !readColoring(in, checkpoint.feasibleColoring, checkpoint.nvertices)
+            || !readValue(in, checkpoint.k))
+    {
+        return false;
+    }
+    if (checkpoint.k <= 0)
+    {
+        checkpoint.k = 0;
+        return true;
+    }
+
+    int tabuSize;
+    if (!readValue(in, checkpoint.iteration)
+            || !readValue(in, checkpoint.lastImprovementIteration)
+            || !readValue(in, checkpoint.randomState)
+            || !readValue(in, checkpoint.tenureFactor)
+            || !readColoring(in, checkpoint.currentColoring, checkpoint.nvertices)
+            || !readColoring(in, checkpoint.bestColoring, checkpoint.nvertices)
+            || !readValue(in, tabuSize) || tabuSize < 0)
+    {
+        return false;
+    }
+    checkpoint.tabuList.resize(tabuSize);
+    for (int i = 0; i < tabuSize; ++i)
+    {
+        if (!readValue(in, checkpoint.tabuList[i].first)
+                || !readValue(in, checkpoint.tabuList[i].second))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool colorsBelow(const std::vector<int>& coloring, int limit)
+{
+    for (unsigned int i = 0; i < coloring.size(); ++i)
+    {
+        if (coloring[i] < 0 || coloring[i] >= limit) return false;
+    }
+    return true;
+}
+
+/**
+ * Reads a checkpoint of a descent on the given instance or, failing that, a
+ * text file with one color per vertex in order, as written by
+ * Solution::print, which becomes a checkpoint with no round in progress.
+ * Returns false if neither can be read or the sizes do not match.
+ */
+bool checkpoint_load(const std::string& fileName, const Instance* instance,
+        TsCheckpoint& checkpoint)
+{
+    if (checkpoint_read(fileName, checkpoint))
+    {
+        if (checkpoint.nvertices != instance->nvertices
+                || checkpoint.nedges != instance->nedges
+                || !colorsBelow(checkpoint.feasibleColoring, instance->nvertices))
+        {
+            return false;
+        }
+        if (checkpoint.k == 0) return true;
+        for (unsigned int i = 0; i < checkpoint.tabuList.size(); ++i)
+        {
+            const std::pair<int, int>& move = checkpoint.tabuList[i];
+            if (move.first < 0 || move.first >= instance->nvertices
+                    || move.second < 0 || move.second >= checkpoint.k)
+            {
+                return false;
+            }
+        }
+        return colorsBelow(checkpoint.currentColoring, checkpoint.k)
+                && colorsBelow(checkpoint.bestColoring, checkpoint.k);
+    }
+
+    std::ifstream in(fileName.c_str(), std::ifstream::in);
+    if (!in.is_open()) return false;
+
+    // Colors are separated by anything that is not a digit
+    std::string text((std::istreambuf_iterator<char>(in)),
+            std::istreambuf_iterator<char>());
+    for (unsigned int i = 0; i < text.size(); ++i)
+    {
+        if (text[i] < '0' || text[i] > '9') text[i] = ' ';
+    }
+    std::istringstream colors(text);
+    checkpoint = TsCheckpoint();
+    int color;
+    while (colors >> color) checkpoint.feasibleColoring.push_back(color);
+
+    checkpoint.nvertices = instance->nvertices;
+    checkpoint.nedges = instance->nedges;
+    return (int) checkpoint.feasibleColoring.size() == instance->nvertices
+            && colorsBelow(checkpoint.feasibleColoring, instance->nvertices);
+}
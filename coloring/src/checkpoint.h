@@ -0,0 +1,40 @@
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "coloring.h"
+
+/**
+ * State of a tabu search descent: the best feasible coloring and, if a round
+ * was in progress, the coloring it was moving, the best coloring of the
+ * round, its iteration counters, its tabu list and tenure factor, and the
+ * state of its random number generator. The instance is identified by its sizes.
+ */
+struct TsCheckpoint
+{
+    int nvertices;
+    int nedges;
+    std::vector<int> feasibleColoring;
+
+    // 0 if no round was in progress
+    int k;
+    long long iteration;
+    long long lastImprovementIteration;
+    std::vector<int> currentColoring;
+    std::vector<int> bestColoring;
+    std::vector<std::pair<int, int> > tabuList;
+    unsigned long long randomState;
+    double tenureFactor;
+
+    TsCheckpoint();
+};
+
+bool checkpoint_write(const std::string& fileName, const TsCheckpoint& checkpoint);
+bool checkpoint_read(const std::string& fileName, TsCheckpoint& checkpoint);
+bool checkpoint_load(const std::string& fileName, const Instance* instance,
+        TsCheckpoint& checkpoint);
+
+#endif /*CHECKPOINT_H_*/
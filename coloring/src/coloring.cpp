@@ -5,43 +5,188 @@
 
 #include "coloring.h"
 
-Instance::Instance(std::istream& in)
+// Passes over the edges when the lists are compressed while parsed; each
+// pass gathers the lists of a range of vertices
+#define COMPRESS_PASSES 8
+
+/**
+ * Reads the next edge line, skipping comments and blank lines, into 0-based
+ * endpoints. Returns false at the end of the stream, or with badbit set on
+ * an endpoint that is not a vertex, as in a corrupt file.
+ */
+bool readEdge(std::istream& in, std::string& line, int nvertices, int& e1,
+        int& e2)
+{
+    while (std::getline(in, line))
+    {
+        if (line.empty() || line[0] == 'c' || line[0] == '\r') continue;
+        std::istringstream ss(line);
+        std::string tag;
+        if (!(ss >> tag >> e1 >> e2)) continue;
+        e1 -= 1;
+        e2 -= 1;
+        if (e1 < 0 || e1 >= nvertices || e2 < 0 || e2 >= nvertices)
+        {
+            in.setstate(std::ios::badbit);
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Parses an instance in DIMACS format. With compressAdjacency, the lists go
+ * straight to their compressed form (see compress): the edges are kept as
+ * pairs, and the lists of a range of vertices at a time are gathered from
+ * them and encoded, so that the uncompressed lists never exist all at once.
+ */
+Instance::Instance(std::istream& in, bool compressAdjacency) :
+    gamma(NULL), compressed(NULL)
 {
-    // Skip header
+    // Skip header; a stream without one gives an empty instance
     std::string tmp("");
-    while (tmp[0] != 'p') std::getline(in, tmp);
+    while (tmp[0] != 'p' && std::getline(in, tmp)) {}
+    if (tmp[0] != 'p') in.setstate(std::ios::badbit);
   
     // Read instance params
     std::stringstream ss(tmp);
+    nvertices = 0;
+    nedges = 0;
     ss >> tmp;
     ss >> tmp;
     ss >> nvertices;
     ss >> nedges;
     ss.clear();
     
-    std::vector<std::vector<int> > adjacency = std::vector<std::vector<int> >(nvertices, std::vector<int>());
-    
     int e1, e2;
+    if (!compressAdjacency)
+    {
+        std::vector<std::vector<int> > adjacency = std::vector<std::vector<int> >(nvertices, std::vector<int>());
+        while (readEdge(in, tmp, nvertices, e1, e2))
+        {
+            adjacency[e1].push_back(e2);
+            adjacency[e2].push_back(e1);
+        }
+        setAdjacency(adjacency);
+        return;
+    }
     
-    // Read lines until the end of file
-    while (!in.eof())
+    std::vector<std::pair<int, int> > edges;
+    edges.reserve(nedges);
+    std::vector<long long> degrees(nvertices, 0);
+    while (readEdge(in, tmp, nvertices, e1, e2))
     {
-    	std::getline(in, tmp);
-    	if (tmp[0] == 'c') continue; // Skip comment lines
-    	
-    	// Parse edge info
-        ss.str(tmp);
-        ss >> tmp;
-        ss >> e1;
-        ss >> e2;
-        e1 -= 1;
-        e2 -= 1;
-        adjacency[e1].push_back(e2);
-        adjacency[e2].push_back(e1);
-        ss.clear();
+        edges.push_back(std::make_pair(e1, e2));
+        degrees[e1]++;
+        degrees[e2]++;
+    }
+    
+    compressed = new CompressedAdjacency();
+    long long rangeEntries = std::max(1LL, 2LL * (long long) edges.size() / COMPRESS_PASSES);
+    std::vector<long long> next;
+    std::vector<int> targets;
+    for (int first = 0, last = 0; first < nvertices; first = last)
+    {
+        long long numEntries = 0;
+        next.clear();
+        while (last < nvertices && (last == first || numEntries + degrees[last] <= rangeEntries))
+        {
+            next.push_back(numEntries);
+            numEntries += degrees[last++];
+        }
+        targets.resize(std::max(1LL, numEntries));
+        for (size_t e = 0; e < edges.size(); ++e)
+        {
+            int u = edges[e].first, v = edges[e].second;
+            if (u >= first && u < last) targets[next[u - first]++] = v;
+            if (v >= first && v < last) targets[next[v - first]++] = u;
+        }
+        for (int u = first, start = 0; u < last; start += degrees[u++])
+            compressed->append(&targets[start], degrees[u]);
     }
+    std::vector<std::pair<int, int> >().swap(edges);
+    std::vector<int>().swap(targets);
+    compressed->finish();
+}
+
+/**
+ * Builds an instance from adjacency lists, in which every edge appears in
+ * the lists of both of its endpoints.
+ */
+Instance::Instance(const std::vector<std::vector<int> >& adjacency) :
+    compressed(NULL)
+{
+    nvertices = adjacency.size();
+    nedges = 0;
+    for (int i = 0; i < nvertices; ++i) nedges += adjacency[i].size();
+    nedges /= 2;
+    
+    setAdjacency(adjacency);
+}
 
-    // Convert vector of int vectors to array of int arrays
+/**
+ * Builds the subgraph induced by the given vertices. Vertex vertices[i] of the
+ * original instance becomes vertex i of the new one.
+ */
+Instance::Instance(const Instance& instance, const std::vector<int>& vertices) :
+    compressed(NULL)
+{
+    nvertices = vertices.size();
+    nedges = 0;
+    
+    // Position of each original vertex in the subgraph, or -1 if left out
+    std::vector<int> newId(instance.nvertices, -1);
+    for (int i = 0; i < nvertices; ++i) newId[vertices[i]] = i;
+    
+    gamma = new int*[nvertices];
+    std::vector<int> neighbors;
+    for (int i = 0; i < nvertices; ++i)
+    {
+        neighbors.clear();
+        
+        // Gets adjacency of the original vertex
+        int* adj = instance.gamma[vertices[i]];
+        
+        // Iteration starts on index 1 and ends adj[0] indices after the start
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            if (newId[*it] != -1) neighbors.push_back(newId[*it]);
+        }
+        
+        int numNeighbors = neighbors.size();
+        gamma[i] = new int[numNeighbors + 1];
+        gamma[i][0] = numNeighbors;
+        std::copy(neighbors.begin(), neighbors.end(), gamma[i] + 1);
+        nedges += numNeighbors;
+    }
+    nedges /= 2;
+}
+
+/**
+ * Builds an instance from compressed sparse rows: the neighbors of vertex u
+ * are targets[offsets[u]] to targets[offsets[u + 1] - 1].
+ */
+Instance::Instance(int nvertices, const std::vector<int>& offsets,
+        const std::vector<int>& targets) :
+    nvertices(nvertices), nedges(offsets[nvertices] / 2), compressed(NULL)
+{
+    gamma = new int*[nvertices];
+    for (int i = 0; i < nvertices; ++i)
+    {
+        int numNeighbors = offsets[i + 1] - offsets[i];
+        gamma[i] = new int[numNeighbors + 1];
+        gamma[i][0] = numNeighbors;
+        std::copy(targets.begin() + offsets[i], targets.begin() + offsets[i + 1],
+                gamma[i] + 1);
+    }
+}
+
+/**
+ * Converts vector of int vectors to array of int arrays.
+ */
+void Instance::setAdjacency(const std::vector<std::vector<int> >& adjacency)
+{
     gamma = new int*[nvertices];
     for (int i = 0; i < nvertices; ++i)
     {
@@ -52,19 +197,39 @@ Instance::Instance(std::istream& in)
     }
 }
 
-Instance::~Instance()
+/**
+ * Replaces the adjacency lists by their compressed form, releasing each list
+ * as soon as it is encoded. Afterwards, neighbors must be read through
+ * degree and neighbors, since gamma is NULL.
+ */
+void Instance::compress()
 {
+    if (compressed != NULL) return;
+    compressed = new CompressedAdjacency();
     for (int i = 0; i < nvertices; ++i)
     {
-        if (gamma[i])
-        {
-            delete[] gamma[i];
-        }
+        compressed->append(gamma[i] + 1, gamma[i][0]);
+        delete[] gamma[i];
     }
+    compressed->finish();
+    delete[] gamma;
+    gamma = NULL;
+}
+
+Instance::~Instance()
+{
     if (gamma)
     {
+        for (int i = 0; i < nvertices; ++i)
+        {
+            if (gamma[i])
+            {
+                delete[] gamma[i];
+            }
+        }
         delete[] gamma;
     }
+    delete compressed;
 }
 
 void Instance::print(std::ostream& out)
@@ -97,7 +262,8 @@ Solution::Solution(Instance* instance) :
     for (int i = 0; i < instance->nvertices; ++i) coloring[i] = -1;
 }
 
-Solution::Solution(const Solution& solution)
+Solution::Solution(const Solution& solution) :
+    coloring(NULL)
 {
     (*this) = solution;
 }
@@ -119,6 +285,7 @@ int Solution::k()
 int Solution::numViolations()
 {
     int violationCount = 0;
+    std::vector<int> buffer;
 	
 	for (int u = 0; u < instance->nvertices; ++u)
 	{
@@ -129,11 +296,10 @@ int Solution::numViolations()
 			violationCount++;
 		}
 		
-        // Gets adjacency of vertex u
-        int* adj = instance->gamma[u];
+        // Gets adjacency of vertex u, which may be compressed
+        const int* adj = instance->neighbors(u, buffer);
         
-        // Iteration starts on index 1 and ends adj[0] indices after the start
-        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        for (const int *it = adj, *end = (it + instance->degree(u)); it != end; ++it)
 		{
             // Check whether there are conflicts between adjacent vertices
 			int v = *it;
@@ -163,9 +329,17 @@ void Solution::print(std::ostream& out)
 
 Solution& Solution::operator=(const Solution& solution)
 {
+    if (this == &solution) return (*this);
+    
+    // Keep the array when the instance does not change, as searches assign
+    // their best solution over and over
+    if (coloring == NULL || instance->nvertices != solution.instance->nvertices)
+    {
+        delete[] coloring;
+        coloring = new int[solution.instance->nvertices];
+    }
     instance = solution.instance;
     maxColor = solution.maxColor;
-    coloring = new int[instance->nvertices];
     for (int i = 0; i < instance->nvertices; ++i)
     {
         coloring[i] = solution.coloring[i];
@@ -2,6 +2,10 @@
 #define COLORING_H_
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "compressed.h"
 
 struct Instance
 {
@@ -9,10 +13,36 @@ struct Instance
     int nedges;
     int** gamma;
     
-    Instance(std::istream& in);
+    // When set, replaces gamma (see compress)
+    CompressedAdjacency* compressed;
+    
+    Instance(std::istream& in, bool compressAdjacency = false);
+    Instance(const std::vector<std::vector<int> >& adjacency);
+    Instance(const Instance& instance, const std::vector<int>& vertices);
+    Instance(int nvertices, const std::vector<int>& offsets,
+            const std::vector<int>& targets);
     ~Instance();
     
     void print(std::ostream& out);
+    void setAdjacency(const std::vector<std::vector<int> >& adjacency);
+    void compress();
+    
+    int degree(int u) const
+    {
+        return (compressed != NULL) ? compressed->degrees[u] : gamma[u][0];
+    }
+    
+    /**
+     * Returns the neighbors of vertex u, decoded into buffer if the
+     * adjacency is compressed.
+     */
+    const int* neighbors(int u, std::vector<int>& buffer) const
+    {
+        if (compressed == NULL) return gamma[u] + 1;
+        buffer.resize(std::max(1, compressed->degrees[u]));
+        compressed->decode(u, &buffer[0]);
+        return &buffer[0];
+    }
 };
 
 struct Solution
@@ -33,4 +63,10 @@ struct Solution
     Solution& operator=(const Solution& solution);
 };
 
+/**
+ * Signature shared by all coloring algorithms, so that they can be chosen by
+ * name and composed with preprocessing stages.
+ */
+typedef void (*ColoringAlgorithm)(Instance* instance, Solution* solution);
+
 #endif /*COLORING_H_*/
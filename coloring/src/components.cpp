@@ -0,0 +1,184 @@
+#include "components.h"
+#include "dsatur.h"
+#include "reduction.h"
+#include "ts.h"
+#include "pgreedy.h"
+#include "timing.h"
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+
+// Components with fewer vertices than this are colored with DSATUR
+#define SMALL_COMPONENT_SIZE 32
+
+struct Component
+{
+    std::vector<int> vertices;
+    bool bipartite;
+
+    // Of the random number generator of the thread coloring the component,
+    // drawn beforehand so that the outcome does not depend on the threads
+    unsigned long long seed;
+};
+
+/**
+ * Comparison used to color the biggest components first, so that threads do
+ * not wait for a big component taken at the end.
+ */
+bool biggerComponent(const Component* c1, const Component* c2)
+{
+    return c1->vertices.size() > c2->vertices.size();
+}
+
+/**
+ * Splits the graph into connected components with a breadth-first search.
+ * As a side effect, each vertex is 2-colored along the search, so that
+ * bipartite components come out already colored, and localId receives the
+ * position of each vertex within its component.
+ */
+void findComponents(Instance* instance, Solution* solution,
+        std::vector<Component>& components, std::vector<int>& localId)
+{
+    int numVertices = instance->nvertices;
+    localId.assign(numVertices, -1);
+
+    for (int s = 0; s < numVertices; ++s)
+    {
+        if (localId[s] != -1) continue;
+
+        components.push_back(Component());
+        Component& component = components.back();
+        component.bipartite = true;
+        std::vector<int>& queue = component.vertices;
+
+        // The component vertices double as the search queue
+        localId[s] = 0;
+        solution->coloring[s] = 0;
+        queue.push_back(s);
+        for (unsigned int head = 0; head < queue.size(); ++head)
+        {
+            int u = queue[head];
+
+            // Gets adjacency of vertex u
+            int* adj = instance->gamma[u];
+
+            // Iteration starts on index 1 and ends adj[0] indices after the start
+            for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+            {
+                int v = *it;
+                if (localId[v] == -1)
+                {
+                    localId[v] = queue.size();
+                    solution->coloring[v] = 1 - solution->coloring[u];
+                    queue.push_back(v);
+                }
+                else if (solution->coloring[v] == solution->coloring[u])
+                {
+                    component.bipartite = false;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Colors one component. Bipartite components keep the 2-coloring found by
+ * the search, small components are colored with DSATUR and the others with
+ * the given algorithm, reducing them first if requested.
+ */
+void colorComponent(Instance* instance, Solution* solution,
+        const Component& component, const std::vector<int>& localId,
+        ColoringAlgorithm algorithm, bool reduce)
+{
+    if (component.bipartite) return;
+
+    const std::vector<int>& vertices = component.vertices;
+    std::vector<std::vector<int> > adjacency(vertices.size());
+    for (unsigned int i = 0; i < vertices.size(); ++i)
+    {
+        int* adj = instance->gamma[vertices[i]];
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            adjacency[i].push_back(localId[*it]);
+        }
+    }
+
+    Instance subInstance(adjacency);
+    Solution subSolution(&subInstance);
+    tsRandom.seed(component.seed);
+    if (subInstance.nvertices < SMALL_COMPONENT_SIZE)
+    {
+        dsatur_constructSolution(&subInstance, &subSolution);
+    }
+    else if (reduce)
+    {
+        reduction_constructSolution(&subInstance, &subSolution, algorithm);
+    }
+    else
+    {
+        algorithm(&subInstance, &subSolution);
+    }
+
+    for (unsigned int i = 0; i < vertices.size(); ++i)
+    {
+        solution->coloring[vertices[i]] = subSolution.coloring[i];
+    }
+}
+
+/**
+ * Worker loop: takes the next component not taken yet, until none is left.
+ * Components are disjoint, so workers write to disjoint positions of the
+ * coloring. Phases are recorded into the timing of the calling thread, and
+ * parallel algorithms get at most threadShare threads.
+ */
+void colorComponents(Instance* instance, Solution* solution,
+        const std::vector<Component*>* queue, const std::vector<int>* localId,
+        ColoringAlgorithm algorithm, bool reduce,
+        std::atomic<unsigned int>* next, Timing* timing, int threadShare)
+{
+    timing_setCurrent(timing);
+    pgreedy_setThreadLimit(threadShare);
+    for (unsigned int i = (*next)++; i < queue->size(); i = (*next)++)
+    {
+        colorComponent(instance, solution, *(*queue)[i], *localId, algorithm,
+                reduce);
+    }
+    pgreedy_setThreadLimit(0);
+}
+
+/**
+ * Colors each connected component independently, using up to numThreads
+ * threads, which the workers split among them. Since every component is
+ * colored from color 0 on, the number of colors is the maximum over all
+ * components.
+ */
+void components_constructSolution(Instance* instance, Solution* solution,
+        ColoringAlgorithm algorithm, int numThreads, bool reduce)
+{
+    std::vector<Component> components;
+    std::vector<int> localId;
+    findComponents(instance, solution, components, localId);
+
+    std::vector<Component*> queue;
+    for (unsigned int i = 0; i < components.size(); ++i)
+    {
+        components[i].seed = tsRandom.next();
+        if (!components[i].bipartite) queue.push_back(&components[i]);
+    }
+    std::sort(queue.begin(), queue.end(), biggerComponent);
+
+    std::atomic<unsigned int> next(0);
+    int numWorkers = std::max(1, std::min(numThreads, (int) queue.size()));
+    int threadShare = std::max(1, numThreads / numWorkers);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numWorkers; ++i)
+    {
+        threads.push_back(std::thread(colorComponents, instance, solution,
+                &queue, &localId, algorithm, reduce, &next, timing_current(),
+                threadShare));
+    }
+    colorComponents(instance, solution, &queue, &localId, algorithm, reduce,
+            &next, timing_current(), threadShare);
+    for (unsigned int i = 0; i < threads.size(); ++i) threads[i].join();
+}
@@ -0,0 +1,9 @@
+#ifndef COMPONENTS_H_
+#define COMPONENTS_H_
+
+#include "coloring.h"
+
+void components_constructSolution(Instance* instance, Solution* solution,
+        ColoringAlgorithm algorithm, int numThreads, bool reduce);
+
+#endif /*COMPONENTS_H_*/
@@ -0,0 +1,191 @@
+#include "compressed.h"
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_SSSE3_DECODER
+#include <tmmintrin.h>
+#endif
+
+// Bytes after the last list, so that a vector load never reads past the end
+#define PADDING 16
+
+CompressedAdjacency::CompressedAdjacency()
+{
+    offsets.push_back(0);
+}
+
+/**
+ * Writes value in the given number of bytes, least significant first.
+ */
+void writeBytes(std::vector<unsigned char>& bytes, unsigned int value, int length)
+{
+    for (int i = 0; i < length; ++i)
+    {
+        bytes.push_back(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+int byteLength(unsigned int value)
+{
+    if (value < (1U << 8)) return 1;
+    if (value < (1U << 16)) return 2;
+    if (value < (1U << 24)) return 3;
+    return 4;
+}
+
+/**
+ * Appends the list of the next vertex. The neighbors are sorted in place.
+ */
+void CompressedAdjacency::append(int* neighbors, int numNeighbors)
+{
+    std::sort(neighbors, neighbors + numNeighbors);
+    degrees.push_back(numNeighbors);
+
+    unsigned int previous = 0;
+    for (int i = 0; i < numNeighbors; i += 4)
+    {
+        int groupSize = std::min(4, numNeighbors - i);
+        unsigned int gaps[4];
+        int control = 0;
+        for (int j = 0; j < groupSize; ++j)
+        {
+            gaps[j] = (unsigned int) neighbors[i + j] - previous;
+            previous = neighbors[i + j];
+            control |= (byteLength(gaps[j]) - 1) << (2 * j);
+        }
+        bytes.push_back(control);
+        for (int j = 0; j < groupSize; ++j)
+            writeBytes(bytes, gaps[j], byteLength(gaps[j]));
+    }
+    offsets.push_back(bytes.size());
+}
+
+/**
+ * Pads the stream after the last list was appended.
+ */
+void CompressedAdjacency::finish()
+{
+    bytes.insert(bytes.end(), PADDING, 0);
+    std::vector<unsigned char>(bytes).swap(bytes);
+}
+
+/**
+ * Decodes the neighbors of vertex u into out, in increasing order.
+ */
+void CompressedAdjacency::decode(int u, int* out) const
+{
+    compressed_decode(&bytes[offsets[u]], degrees[u], out);
+}
+
+/**
+ * Returns the memory taken by the lists and their index, in bytes.
+ */
+size_t CompressedAdjacency::size() const
+{
+    return bytes.size() + offsets.size() * sizeof(size_t)
+            + degrees.size() * sizeof(int);
+}
+
+void compressed_decodeScalar(const unsigned char* in, int count, int* out)
+{
+    unsigned int previous = 0;
+    for (int i = 0; i < count; i += 4)
+    {
+        int control = *in++;
+        int groupSize = std::min(4, count - i);
+        for (int j = 0; j < groupSize; ++j)
+        {
+            int length = ((control >> (2 * j)) & 3) + 1;
+            unsigned int gap = 0;
+            for (int b = 0; b < length; ++b) gap |= (unsigned int) in[b] << (8 * b);
+            in += length;
+            previous += gap;
+            out[i + j] = previous;
+        }
+    }
+}
+
+#ifdef HAVE_SSSE3_DECODER
+
+/**
+ * For each control byte, the shuffle that spreads the bytes of the four gaps
+ * into four 32-bit lanes, and the number of bytes they take.
+ */
+struct ShuffleTable
+{
+    unsigned char masks[256][16];
+    unsigned char lengths[256];
+
+    ShuffleTable()
+    {
+        for (int control = 0; control < 256; ++control)
+        {
+            int position = 0;
+            for (int j = 0; j < 4; ++j)
+            {
+                int length = ((control >> (2 * j)) & 3) + 1;
+                for (int b = 0; b < 4; ++b)
+                    masks[control][4 * j + b] = (b < length) ? position + b : 0x80;
+                position += length;
+            }
+            lengths[control] = position;
+        }
+    }
+};
+
+__attribute__((target("ssse3")))
+void decodeSsse3(const unsigned char* in, int count, int* out)
+{
+    static const ShuffleTable table;
+    __m128i previous = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        int control = *in++;
+        __m128i data = _mm_loadu_si128((const __m128i*) in);
+        __m128i mask = _mm_loadu_si128((const __m128i*) table.masks[control]);
+        __m128i gaps = _mm_shuffle_epi8(data, mask);
+        in += table.lengths[control];
+
+        // Prefix sum of the gaps, plus the last neighbor of the previous group
+        gaps = _mm_add_epi32(gaps, _mm_slli_si128(gaps, 4));
+        gaps = _mm_add_epi32(gaps, _mm_slli_si128(gaps, 8));
+        __m128i neighbors = _mm_add_epi32(gaps, previous);
+        _mm_storeu_si128((__m128i*) (out + i), neighbors);
+        previous = _mm_shuffle_epi32(neighbors, 0xFF);
+    }
+    if (i < count)
+    {
+        compressed_decodeScalar(in, count - i, out + i);
+        int last = (i > 0) ? out[i - 1] : 0;
+        for (int j = i; j < count; ++j) out[j] += last;
+    }
+}
+
+#endif
+
+bool compressed_simdAvailable()
+{
+#ifdef HAVE_SSSE3_DECODER
+    static const bool available = __builtin_cpu_supports("ssse3");
+    return available;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Decodes count neighbors, with SSSE3 shuffles when the processor has them.
+ */
+void compressed_decode(const unsigned char* in, int count, int* out)
+{
+#ifdef HAVE_SSSE3_DECODER
+    if (compressed_simdAvailable())
+    {
+        decodeSsse3(in, count, out);
+        return;
+    }
+#endif
+    compressed_decodeScalar(in, count, out);
+}
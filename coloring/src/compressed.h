@@ -0,0 +1,33 @@
+#ifndef COMPRESSED_H_
+#define COMPRESSED_H_
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * Adjacency lists stored sorted and delta-encoded with group varint. Each
+ * group of four gaps starts with a control byte giving their lengths in
+ * bytes, minus one, two bits each; the gaps follow in little-endian order.
+ * The first value of a list is the first neighbor itself. Most gaps fit in
+ * one or two bytes, against four for a plain neighbor id.
+ */
+struct CompressedAdjacency
+{
+    // Start of the list of each vertex in bytes, plus the end of the last
+    std::vector<size_t> offsets;
+    std::vector<int> degrees;
+    std::vector<unsigned char> bytes;
+
+    CompressedAdjacency();
+
+    void append(int* neighbors, int numNeighbors);
+    void finish();
+    void decode(int u, int* out) const;
+    size_t size() const;
+};
+
+bool compressed_simdAvailable();
+void compressed_decodeScalar(const unsigned char* in, int count, int* out);
+void compressed_decode(const unsigned char* in, int count, int* out);
+
+#endif /*COMPRESSED_H_*/
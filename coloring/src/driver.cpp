@@ -0,0 +1,202 @@
+#include "driver.h"
+#include "reduction.h"
+#include "components.h"
+#include "island.h"
+#include "extraction.h"
+#include "inputstream.h"
+#include "ts.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+RunOptions::RunOptions() :
+    reduce(false), decompose(false), numThreads(1), numIslands(1),
+    migrationInterval(10000), residualFraction(1.0), compress(false)
+{
+}
+
+/**
+ * Runs the coloring algorithm, wrapped by the stages selected in options.
+ */
+void driver_runAlgorithm(Instance* instance, Solution* solution,
+        ColoringAlgorithm algorithm, const RunOptions& options)
+{
+    if (options.numIslands > 1)
+    {
+        island_constructSolution(instance, solution, algorithm,
+                options.numIslands, options.migrationInterval);
+    }
+    else if (options.residualFraction < 1.0)
+    {
+        extraction_constructSolution(instance, solution, algorithm,
+                options.residualFraction);
+    }
+    else if (options.decompose)
+    {
+        components_constructSolution(instance, solution, algorithm,
+                options.numThreads, options.reduce);
+    }
+    else if (options.reduce)
+    {
+        reduction_constructSolution(instance, solution, algorithm);
+    }
+    else
+    {
+        algorithm(instance, solution);
+    }
+}
+
+/**
+ * Writes the tab-separated result line used in the reports. The elapsed
+ * time in whole seconds is followed by the nanoseconds spent parsing, in
+ * constructive heuristics and in the remaining search, the number of local
+ * search iterations, and then by the nanoseconds of each tabu search round
+ * as k:time pairs (or "-" if none).
+ * When components are colored concurrently, their phases add up, so the
+ * construction time may exceed the elapsed time. With hardware counters
+ * enabled, three more columns give the counts for parsing, construction and
+ * each round, as cycles/instructions/cache misses/branch misses.
+ */
+void driver_printResult(std::ostream& out, const std::string& fileName,
+        Instance* instance, Solution* solution, Timing& timing)
+{
+    int numViolations = solution->numViolations();
+    std::string instanceName = inputstream_stripCompression(fileName);
+    if (numViolations == 0)
+    {
+        out << instanceName.substr(0, instanceName.size() - 4) << "\t"
+                << instance->nvertices << "\t"
+                << instance->nedges << "\t"
+                << solution->k() << "\t"
+                << timing.total / 1000000000 << "\t"
+                << timing.parse << "\t"
+                << timing.construction << "\t"
+                << timing.total - timing.construction << "\t"
+                << timing.iterations << "\t";
+        for (unsigned int i = 0; i < timing.roundK.size(); ++i)
+        {
+            if (i > 0) out << ",";
+            out << timing.roundK[i] << ":" << timing.roundTime[i];
+        }
+        if (timing.roundK.empty()) out << "-";
+        if (hwcounters_enabled())
+        {
+            out << "\t";
+            hwcounters_print(out, timing.parseCounts);
+            out << "\t";
+            hwcounters_print(out, timing.constructionCounts);
+            out << "\t";
+            for (unsigned int i = 0; i < timing.roundK.size(); ++i)
+            {
+                if (i > 0) out << ",";
+                out << timing.roundK[i] << ":";
+                hwcounters_print(out, timing.roundCounts[i]);
+            }
+            if (timing.roundK.empty()) out << "-";
+        }
+        out << std::endl;
+    }
+    else
+    {
+        out << instanceName.substr(0, instanceName.size() - 4)
+                << " Feasible solution not found. "
+                << "(" << numViolations << " violations)" << std::endl;
+    }
+}
+
+/**
+ * Runs one batch job, returning its result line. Instance and solution
+ * belong to the job and are released as soon as it finishes. The run number
+ * identifies the job in traces, and the seed starts the random number
+ * generator of the thread.
+ */
+std::string runJob(const BatchJob& job, const RunOptions& options, int run,
+        unsigned long long seed)
+{
+    std::ostringstream row;
+    tsRandom.seed(seed);
+
+    InputStream in;
+    in.open(job.fileName);
+    if (!in.is_open())
+    {
+        row << job.fileName << " Could not open instance file." << std::endl;
+        return row.str();
+    }
+
+    Timing timing;
+    timing.run = run;
+    timing_setCurrent(&timing);
+
+    PhaseStart parse;
+    timing_beginPhase(parse);
+    Instance instance(in, options.compress);
+    Solution solution(&instance);
+    bool corrupt = in.bad();
+    in.close();
+    timing_endParse(parse);
+    if (corrupt)
+    {
+        timing_setCurrent(NULL);
+        row << job.fileName << " Invalid or corrupt instance file." << std::endl;
+        return row.str();
+    }
+
+    timing.start = timing_now();
+    driver_runAlgorithm(&instance, &solution, job.algorithm, options);
+    timing.total = timing_now() - timing.start;
+
+    timing_setCurrent(NULL);
+    driver_printResult(row, job.fileName, &instance, &solution, timing);
+    return row.str();
+}
+
+/**
+ * Worker loop: runs the next job not taken yet and writes its result line,
+ * followed by a column with the name of the algorithm, as soon as it
+ * finishes.
+ */
+void runJobs(const std::vector<BatchJob>* jobs,
+        const std::vector<unsigned long long>* seeds, const RunOptions* options,
+        std::ostream* out, std::mutex* outMutex,
+        std::atomic<unsigned int>* next)
+{
+    for (unsigned int i = (*next)++; i < jobs->size(); i = (*next)++)
+    {
+        std::string row = runJob((*jobs)[i], *options, i, (*seeds)[i]);
+        row.insert(row.size() - 1, "\t" + (*jobs)[i].algorithmName);
+
+        std::lock_guard<std::mutex> lock(*outMutex);
+        (*out) << row << std::flush;
+    }
+}
+
+/**
+ * Runs all jobs on numWorkers threads. Result lines are streamed in the
+ * order the jobs finish, each in the report format with the name of its
+ * algorithm as the last column.
+ */
+void driver_runBatch(const std::vector<BatchJob>& jobs,
+        const RunOptions& options, int numWorkers, std::ostream& out)
+{
+    std::mutex outMutex;
+    std::atomic<unsigned int> next(0);
+    numWorkers = std::max(1, std::min(numWorkers, (int) jobs.size()));
+
+    // Seeds are drawn here so that the results do not depend on the worker
+    // that takes each job
+    std::vector<unsigned long long> seeds(jobs.size());
+    for (unsigned int i = 0; i < jobs.size(); ++i) seeds[i] = tsRandom.next();
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < numWorkers; ++i)
+    {
+        workers.push_back(std::thread(runJobs, &jobs, &seeds, &options, &out,
+                &outMutex, &next));
+    }
+    runJobs(&jobs, &seeds, &options, &out, &outMutex, &next);
+    for (unsigned int i = 0; i < workers.size(); ++i) workers[i].join();
+}
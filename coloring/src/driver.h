@@ -0,0 +1,46 @@
+#ifndef DRIVER_H_
+#define DRIVER_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "coloring.h"
+#include "timing.h"
+
+/**
+ * Stages applied around the coloring algorithm.
+ */
+struct RunOptions
+{
+    bool reduce;
+    bool decompose;
+    int numThreads;
+    int numIslands;
+    int migrationInterval;
+    double residualFraction;
+    bool compress;
+
+    RunOptions();
+};
+
+/**
+ * One algorithm run over one instance file.
+ */
+struct BatchJob
+{
+    std::string algorithmName;
+    ColoringAlgorithm algorithm;
+    std::string fileName;
+};
+
+void driver_runAlgorithm(Instance* instance, Solution* solution,
+        ColoringAlgorithm algorithm, const RunOptions& options);
+
+void driver_printResult(std::ostream& out, const std::string& fileName,
+        Instance* instance, Solution* solution, Timing& timing);
+
+void driver_runBatch(const std::vector<BatchJob>& jobs,
+        const RunOptions& options, int numWorkers, std::ostream& out);
+
+#endif /*DRIVER_H_*/
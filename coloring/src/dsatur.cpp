@@ -1,4 +1,11 @@
 #include "dsatur.h"
+#include "timing.h"
+#include <vector>
+#include <algorithm>
+
+// Vertices up to which the colors adjacent to each vertex are kept in a row
+// of n bytes rather than in a sorted list
+#define DENSE_MAX_VERTICES 10000
 
 /**
  * Returns the maximum saturated vertex. Saturation is given by the number of
@@ -40,45 +47,93 @@ int maximumSaturatedVertex(int* uncolored, int uncoloredSize,
 }
 
 /**
- * Finds the minimum color for coloring vertex without creating any conflicts.
+ * Colors adjacent to each vertex as 0-1 rows indexed by color, which take
+ * n bytes per vertex.
  */
-int minFeasibleColor(int v, char** adjColors)
+struct DenseAdjColors
 {
-	char* colors = adjColors[v];
-	int minFeasibleColor = -1;
-	bool foundMinFeasibleColor = false;
-	for (int color = 0; !foundMinFeasibleColor; ++color)
-	{
-		if (colors[color] == 0)
-		{
-			minFeasibleColor = color;
-			foundMinFeasibleColor = true;
-		}
-	}
-	return minFeasibleColor;
-}
+    std::vector<char*> rows;
+
+    DenseAdjColors(int numVertices) : rows(numVertices)
+    {
+        for (int i = 0; i < numVertices; ++i)
+        {
+            rows[i] = new char[numVertices];
+            for (int j = 0; j < numVertices; ++j) rows[i][j] = 0;
+        }
+    }
+
+    ~DenseAdjColors()
+    {
+        for (size_t i = 0; i < rows.size(); ++i) delete[] rows[i];
+    }
+
+    // Returns true if color was not adjacent to v yet
+    bool add(int v, int color)
+    {
+        if (rows[v][color] != 0) return false;
+        rows[v][color] = 1;
+        return true;
+    }
+
+    // Minimum color not adjacent to v
+    int minAbsent(int v) const
+    {
+        int color = 0;
+        while (rows[v][color] != 0) ++color;
+        return color;
+    }
+};
+
+/**
+ * Colors adjacent to each vertex as sorted lists, which take memory in the
+ * order of the edges, for big or compressed instances.
+ */
+struct SparseAdjColors
+{
+    std::vector<std::vector<int> > lists;
+
+    SparseAdjColors(int numVertices) : lists(numVertices) {}
+
+    bool add(int v, int color)
+    {
+        std::vector<int>& colors = lists[v];
+        std::vector<int>::iterator it = std::lower_bound(colors.begin(),
+                colors.end(), color);
+        if (it != colors.end() && *it == color) return false;
+        colors.insert(it, color);
+        return true;
+    }
+
+    int minAbsent(int v) const
+    {
+        const std::vector<int>& colors = lists[v];
+        int color = 0;
+        while (color < (int) colors.size() && colors[color] == color) ++color;
+        return color;
+    }
+};
 
 /**
  * Update adjacencies of vertex after setting its color.
  */
+template <class AdjColors>
 void updateAdjacencies(Instance* instance, Solution* solution, int vertexId,
-		int color, char** adjColors, int* numAdjColors, int* numAdjUncolored)
+		int color, AdjColors& adjColors, int* numAdjColors, int* numAdjUncolored,
+		std::vector<int>& buffer)
 {
-    // Gets adjacency of vertex vertexId
-    int* adj = instance->gamma[vertexId];
+    // Gets adjacency of vertex vertexId, which may be compressed
+    const int* adj = instance->neighbors(vertexId, buffer);
     
-    // Iteration starts on index 1 and ends adj[0] indices after the start
-	for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+	for (const int *it = adj, *end = (it + instance->degree(vertexId)); it != end; ++it)
 	{
 		int adjVertexId = *it;
 		
 		// Only update if the adjacent vertex is uncolored
 		if (solution->coloring[adjVertexId] == -1)
 		{
-			char* colors = adjColors[adjVertexId];
-			if (colors[color] == 0)
+			if (adjColors.add(adjVertexId, color))
 			{
-				colors[color] = 1;
 				++numAdjColors[adjVertexId];
 			}
 			--numAdjUncolored[adjVertexId];
@@ -86,11 +141,38 @@ void updateAdjacencies(Instance* instance, Solution* solution, int vertexId,
 	}
 }
 
+/**
+ * Colors one vertex at a time, the most saturated first, with the minimum
+ * color that creates no conflicts.
+ */
+template <class AdjColors>
+void colorVertices(Instance* instance, Solution* solution, int* uncolored,
+        int* numAdjColors, int* numAdjUncolored)
+{
+    AdjColors adjColors(instance->nvertices);
+    
+    // Decoded adjacency of the last colored vertex
+    std::vector<int> buffer;
+	
+    for (int uncoloredSize = instance->nvertices; uncoloredSize > 0; --uncoloredSize)
+	{
+    	int maxVertex = maximumSaturatedVertex(uncolored, uncoloredSize,
+                numAdjColors, numAdjUncolored);
+		int color = adjColors.minAbsent(maxVertex);
+		
+		solution->coloring[maxVertex] = color;
+		updateAdjacencies(instance, solution, maxVertex, color, adjColors,
+                numAdjColors, numAdjUncolored, buffer);
+	}
+}
+
 /**
  * Builds a solution using the DSATUR constructive heuristic.
  */
 void dsatur_constructSolution(Instance* instance, Solution* solution)
 {
+    PhaseStart phase;
+    timing_beginPhase(phase);
 	int numVertices = instance->nvertices;
 
 	// Initialize data structures
@@ -104,8 +186,7 @@ void dsatur_constructSolution(Instance* instance, Solution* solution)
     int* numAdjUncolored = new int[numVertices];
     for (int i = 0; i < numVertices; ++i)
     {
-        // Index zero of gamma[i] contains the its size
-        numAdjUncolored[i] = instance->gamma[i][0];
+        numAdjUncolored[i] = instance->degree(i);
     }
     
     // The v-th position of numAdjUncolored contains the number of different
@@ -113,37 +194,19 @@ void dsatur_constructSolution(Instance* instance, Solution* solution)
     int* numAdjColors = new int[numVertices];
     for (int i = 0; i < numVertices; ++i) numAdjColors[i] = 0;
     
-	// For each vertex v, adjColors contains a 0-1 vector where the content of
-	// index c indicates if color c is used in the adjacency of v
-    char** adjColors = new char*[numVertices];
-    for (int i = 0; i < numVertices; ++i)
-    {
-    	adjColors[i] = new char[numVertices];
-    	for (int j = 0; j < numVertices; ++j)
-    	{
-    		adjColors[i][j] = 0;
-    	}
-    }
-	
-	// Color one vertex at a time, until all vertices are colored
-    for (int uncoloredSize = numVertices; uncoloredSize >= 0; --uncoloredSize)
-	{
-    	int maxVertex = maximumSaturatedVertex(uncolored, uncoloredSize,
+    // Compressed instances are meant to be big, and n bytes per vertex would
+    // defeat the compression
+    if (instance->compressed == NULL && numVertices <= DENSE_MAX_VERTICES)
+        colorVertices<DenseAdjColors>(instance, solution, uncolored,
                 numAdjColors, numAdjUncolored);
-		int color = minFeasibleColor(maxVertex, adjColors);
-		
-		solution->coloring[maxVertex] = color;
-		updateAdjacencies(instance, solution, maxVertex, color, adjColors,
+    else
+        colorVertices<SparseAdjColors>(instance, solution, uncolored,
                 numAdjColors, numAdjUncolored);
-	}
 
     // Clean data structures
     if (uncolored) delete[] uncolored;
-    for (int i = 0; i < numVertices; ++i)
-    {
-    	if (adjColors[i]) delete[] adjColors[i];
-    }
-    if (adjColors) delete[] adjColors;
     if (numAdjColors) delete[] numAdjColors;
     if (numAdjUncolored) delete[] numAdjUncolored;
+
+    timing_addConstruction(phase);
 }
@@ -0,0 +1,267 @@
+#include "extraction.h"
+#include "timing.h"
+#include "ts.h"
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+// Above this many vertices the adjacency matrix would not fit in memory, and
+// the graph is left to the algorithm as a whole
+#define MAX_BITSET_VERTICES 32768
+
+// Perturbations of the local search for each extracted set
+#define PERTURBATIONS_PER_SET 200
+
+/**
+ * Adjacency matrix with one bit per pair, plus the set of vertices left to
+ * color, so that neighborhoods within the residual graph are word operations.
+ */
+struct BitGraph
+{
+    int numVertices;
+    int numWords;
+    std::vector<uint64_t> rows;
+    std::vector<uint64_t> remaining;
+
+    BitGraph(Instance* instance);
+
+    const uint64_t* row(int u) const { return &rows[(size_t) u * numWords]; }
+    bool adjacent(int u, int v) const { return (row(u)[v >> 6] >> (v & 63)) & 1; }
+};
+
+BitGraph::BitGraph(Instance* instance) :
+    numVertices(instance->nvertices), numWords((instance->nvertices + 63) / 64),
+    rows((size_t) numVertices * numWords, 0), remaining(numWords, 0)
+{
+    for (int u = 0; u < numVertices; ++u)
+    {
+        uint64_t* bits = &rows[(size_t) u * numWords];
+        int* adj = instance->gamma[u];
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+            bits[*it >> 6] |= 1ULL << (*it & 63);
+        remaining[u >> 6] |= 1ULL << (u & 63);
+    }
+}
+
+inline void setBit(std::vector<uint64_t>& bits, int i) { bits[i >> 6] |= 1ULL << (i & 63); }
+inline void clearBit(std::vector<uint64_t>& bits, int i) { bits[i >> 6] &= ~(1ULL << (i & 63)); }
+inline bool testBit(const std::vector<uint64_t>& bits, int i) { return (bits[i >> 6] >> (i & 63)) & 1; }
+
+/**
+ * Appends to vertices the residual neighbors of u, optionally only those
+ * outside of the set.
+ */
+void residualNeighbors(const BitGraph& graph, int u, const std::vector<uint64_t>* outside,
+        std::vector<int>& vertices)
+{
+    const uint64_t* row = graph.row(u);
+    for (int w = 0; w < graph.numWords; ++w)
+    {
+        uint64_t bits = row[w] & graph.remaining[w];
+        if (outside != NULL) bits &= ~(*outside)[w];
+        while (bits != 0)
+        {
+            vertices.push_back((w << 6) + __builtin_ctzll(bits));
+            bits &= bits - 1;
+        }
+    }
+}
+
+/**
+ * Independent set of the residual graph under local search. tight[v] is the
+ * number of neighbors of v in the set, for residual vertices.
+ */
+struct IndependentSet
+{
+    const BitGraph* graph;
+    std::vector<uint64_t> members;
+    std::vector<int> tight;
+    int size;
+    std::vector<int> neighbors;
+
+    IndependentSet(const BitGraph* graph) :
+        graph(graph), members(graph->numWords, 0), tight(graph->numVertices, 0),
+        size(0) {}
+
+    void insert(int u)
+    {
+        setBit(members, u);
+        size++;
+        neighbors.clear();
+        residualNeighbors(*graph, u, NULL, neighbors);
+        for (unsigned int i = 0; i < neighbors.size(); ++i) tight[neighbors[i]]++;
+    }
+
+    void remove(int u)
+    {
+        clearBit(members, u);
+        size--;
+        neighbors.clear();
+        residualNeighbors(*graph, u, NULL, neighbors);
+        for (unsigned int i = 0; i < neighbors.size(); ++i) tight[neighbors[i]]--;
+    }
+
+    /**
+     * Adds free vertices, i.e. with no neighbor in the set, in the given
+     * order until the set is maximal.
+     */
+    void complete(const std::vector<int>& order)
+    {
+        for (unsigned int i = 0; i < order.size(); ++i)
+        {
+            int u = order[i];
+            if (tight[u] == 0 && !testBit(members, u)) insert(u);
+        }
+    }
+
+    /**
+     * Applies (1,2)-swaps, which remove a vertex of the set and insert two
+     * of its neighbors that only have it in the set, until none is left.
+     */
+    void improve(const std::vector<int>& order)
+    {
+        std::vector<int> candidates;
+        bool improved = true;
+        while (improved)
+        {
+            improved = false;
+            for (unsigned int i = 0; i < order.size() && !improved; ++i)
+            {
+                int x = order[i];
+                if (!testBit(members, x)) continue;
+
+                candidates.clear();
+                residualNeighbors(*graph, x, &members, candidates);
+                for (unsigned int a = 0; a < candidates.size() && !improved; ++a)
+                {
+                    int u = candidates[a];
+                    if (tight[u] != 1) continue;
+                    for (unsigned int b = a + 1; b < candidates.size(); ++b)
+                    {
+                        int v = candidates[b];
+                        if (tight[v] != 1 || graph->adjacent(u, v)) continue;
+                        remove(x);
+                        insert(u);
+                        insert(v);
+                        complete(order);
+                        improved = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+};
+
+/**
+ * Finds a large maximal independent set of the residual graph: greedily in
+ * order of increasing residual degree, then by iterated local search, where
+ * each perturbation forces a random vertex into the set.
+ */
+void extractIndependentSet(const BitGraph& graph, std::vector<int>& best)
+{
+    // Residual vertices by increasing residual degree
+    std::vector<std::pair<int, int> > byDegree;
+    for (int u = 0; u < graph.numVertices; ++u)
+    {
+        if (!testBit(graph.remaining, u)) continue;
+        const uint64_t* row = graph.row(u);
+        int degree = 0;
+        for (int w = 0; w < graph.numWords; ++w)
+            degree += __builtin_popcountll(row[w] & graph.remaining[w]);
+        byDegree.push_back(std::make_pair(degree, u));
+    }
+    std::sort(byDegree.begin(), byDegree.end());
+    std::vector<int> order(byDegree.size());
+    for (unsigned int i = 0; i < byDegree.size(); ++i) order[i] = byDegree[i].second;
+
+    IndependentSet current(&graph);
+    current.complete(order);
+    current.improve(order);
+    IndependentSet bestSet = current;
+
+    std::vector<int> neighbors;
+    for (int p = 0; p < PERTURBATIONS_PER_SET; ++p)
+    {
+        int u = order[tsRandom(order.size())];
+        if (testBit(current.members, u)) continue;
+
+        neighbors.clear();
+        residualNeighbors(graph, u, NULL, neighbors);
+        for (unsigned int i = 0; i < neighbors.size(); ++i)
+        {
+            if (testBit(current.members, neighbors[i])) current.remove(neighbors[i]);
+        }
+        current.insert(u);
+        current.complete(order);
+        current.improve(order);
+
+        if (current.size >= bestSet.size)
+            bestSet = current;
+        else if (tsRandom(2) == 0)
+            current = bestSet;
+    }
+
+    best.clear();
+    for (unsigned int i = 0; i < order.size(); ++i)
+    {
+        if (testBit(bestSet.members, order[i])) best.push_back(order[i]);
+    }
+}
+
+/**
+ * Removes large independent sets, each of which becomes a color class, until
+ * at most residualFraction of the vertices are left. The residual graph is
+ * then colored by the algorithm, with colors after those of the sets.
+ */
+void extraction_constructSolution(Instance* instance, Solution* solution,
+        ColoringAlgorithm algorithm, double residualFraction)
+{
+    int numVertices = instance->nvertices;
+    if (numVertices > MAX_BITSET_VERTICES)
+    {
+        algorithm(instance, solution);
+        return;
+    }
+
+    PhaseStart phase;
+    timing_beginPhase(phase);
+
+    BitGraph graph(instance);
+    int numRemaining = numVertices;
+    int numSets = 0;
+    std::vector<int> independentSet;
+    while (numRemaining > residualFraction * numVertices)
+    {
+        extractIndependentSet(graph, independentSet);
+
+        // Sets of a single vertex gain nothing over the algorithm
+        if (independentSet.size() < 2) break;
+        for (unsigned int i = 0; i < independentSet.size(); ++i)
+        {
+            solution->coloring[independentSet[i]] = numSets;
+            clearBit(graph.remaining, independentSet[i]);
+        }
+        numRemaining -= independentSet.size();
+        numSets++;
+    }
+
+    std::vector<int> residualVertices;
+    for (int u = 0; u < numVertices; ++u)
+    {
+        if (testBit(graph.remaining, u)) residualVertices.push_back(u);
+    }
+    timing_addConstruction(phase);
+
+    if (!residualVertices.empty())
+    {
+        Instance residual(*instance, residualVertices);
+        Solution residualSolution(&residual);
+        algorithm(&residual, &residualSolution);
+        for (int i = 0; i < residual.nvertices; ++i)
+        {
+            solution->coloring[residualVertices[i]] =
+                    numSets + residualSolution.coloring[i];
+        }
+    }
+}
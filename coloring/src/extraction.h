@@ -0,0 +1,9 @@
+#ifndef EXTRACTION_H_
+#define EXTRACTION_H_
+
+#include "coloring.h"
+
+void extraction_constructSolution(Instance* instance, Solution* solution,
+        ColoringAlgorithm algorithm, double residualFraction);
+
+#endif /*EXTRACTION_H_*/
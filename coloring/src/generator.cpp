@@ -0,0 +1,337 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+/**
+ * Generates random graphs in DIMACS .col format on the standard output.
+ * Graphs are streamed twice from the same seed, first to count the edges
+ * written in the header and then to write them, so memory does not grow with
+ * the size of the graph.
+ */
+
+/**
+ * Mixes a 64-bit value (splitmix64 finalizer). Used both as the step of the
+ * random number generator and to derive values from vertex ids.
+ */
+unsigned long long mix(unsigned long long x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Returns a double uniformly distributed in [0, 1) from 64 random bits.
+ */
+double toUniform(unsigned long long bits)
+{
+    return (bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+struct Random
+{
+    unsigned long long state;
+
+    Random(unsigned long long seed) : state(seed) {}
+
+    double uniform()
+    {
+        state += 0x9E3779B97F4A7C15ULL;
+        return toUniform(mix(state));
+    }
+
+    /**
+     * Number of failures before the first success in Bernoulli trials with
+     * probability p, used to skip over pairs that are not edges.
+     */
+    long long skip(double p)
+    {
+        if (p >= 1) return 0;
+        double r = uniform();
+        return (long long) std::floor(std::log(1 - r) / std::log(1 - p));
+    }
+
+    /**
+     * Number of successes in the given number of Bernoulli trials with
+     * probability p, found by skipping the failures, so in time proportional
+     * to the successes.
+     */
+    long long binomial(long long trials, double p)
+    {
+        long long successes = 0;
+        for (long long t = skip(p); t < trials; t += 1 + skip(p)) ++successes;
+        return successes;
+    }
+};
+
+/**
+ * Receives the edges of the graph, either counting or writing them.
+ */
+struct EdgeSink
+{
+    bool write;
+    long long count;
+
+    EdgeSink(bool write) : write(write), count(0) {}
+
+    void edge(long long u, long long v)
+    {
+        ++count;
+        if (write) std::cout << "e " << (u + 1) << " " << (v + 1) << '\n';
+    }
+};
+
+/**
+ * G(n, p) graph, like the DSJC instances. Pairs (w, v) with w < v are
+ * visited in order, skipping geometrically distributed runs of non-edges.
+ * When k > 0, vertex v belongs to class v mod k, only pairs in distinct
+ * classes are edges and vertices 0..k-1 form a clique, so the chromatic
+ * number is exactly k (a planted k-coloring, in the spirit of the Leighton
+ * instances).
+ */
+void generateUniform(long long n, double p, int k, unsigned long long seed,
+        EdgeSink& sink)
+{
+    Random random(seed);
+
+    for (long long v = 1; v < k; ++v)
+    {
+        for (long long w = 0; w < v; ++w) sink.edge(w, v);
+    }
+    if (p <= 0) return;
+
+    long long v = 1;
+    long long w = -1;
+    while (v < n)
+    {
+        w += 1 + random.skip(p);
+        while (w >= v && v < n)
+        {
+            w -= v;
+            ++v;
+        }
+        if (v >= n) break;
+        if (k > 0 && (v < k || v % k == w % k)) continue;
+        sink.edge(w, v);
+    }
+}
+
+/**
+ * Draws the number of points of each cell of row cy, as a binomial of the
+ * points left over the cells left, which gives the counts of independent
+ * points. row[cx] receives the first vertex of cell cx of the row, given the
+ * first vertex of the row, and row[side] the first vertex of the next row.
+ */
+void drawCellRow(Random& random, long long n, long long side, long long cy,
+        long long firstOfRow, std::vector<long long>& row)
+{
+    long long numCells = side * side;
+    row[0] = firstOfRow;
+    for (long long cx = 0; cx < side; ++cx)
+    {
+        long long cell = cy * side + cx;
+        row[cx + 1] = row[cx] + random.binomial(n - row[cx],
+                1.0 / (numCells - cell));
+    }
+}
+
+/**
+ * Random geometric graph: n points drawn independently and uniformly in the
+ * unit square, adjacent when closer than radius. The square is split into
+ * cells of side at least radius, and vertex ids are assigned cell by cell,
+ * so only neighboring cells have to be compared. There are at most about n
+ * cells, so that empty cells do not dominate the time when the radius is
+ * small. The counts of a row of cells are drawn just before the row above
+ * it is compared with it, so only two rows are kept. Point coordinates
+ * within a cell are derived from the vertex id, so each cell can be
+ * regenerated whenever it is needed.
+ */
+void generateGeometric(long long n, double radius, unsigned long long seed,
+        EdgeSink& sink)
+{
+    long long side = std::max(1LL, std::min((long long) std::floor(1 / radius),
+            (long long) std::sqrt((double) n)));
+    double radius2 = radius * radius;
+
+    Random random(seed);
+    std::vector<long long> row(side + 1), nextRow(side + 1);
+    drawCellRow(random, n, side, 0, 0, row);
+
+    std::vector<double> x1, y1, x2, y2;
+    for (long long cy = 0; cy < side; ++cy)
+    {
+        if (cy + 1 < side) drawCellRow(random, n, side, cy + 1, row[side], nextRow);
+
+        for (long long cx = 0; cx < side; ++cx)
+        {
+            long long first1 = row[cx];
+            long long size1 = row[cx + 1] - first1;
+            if (size1 == 0) continue;
+
+            // Cells right, below-left, below and below-right, then the cell itself
+            static const int dx[] = { 1, -1, 0, 1, 0 };
+            static const int dy[] = { 0, 1, 1, 1, 0 };
+            for (int d = 0; d < 5; ++d)
+            {
+                long long nx = cx + dx[d];
+                long long ny = cy + dy[d];
+                if (nx < 0 || nx >= side || ny >= side) continue;
+                const std::vector<long long>& otherRow = (ny == cy) ? row : nextRow;
+                long long first2 = otherRow[nx];
+                long long size2 = otherRow[nx + 1] - first2;
+
+                x1.resize(size1);
+                y1.resize(size1);
+                for (long long i = 0; i < size1; ++i)
+                {
+                    unsigned long long h = mix(seed ^ mix(first1 + i));
+                    x1[i] = (cx + toUniform(h)) / side;
+                    y1[i] = (cy + toUniform(mix(h))) / side;
+                }
+                x2.resize(size2);
+                y2.resize(size2);
+                for (long long j = 0; j < size2; ++j)
+                {
+                    unsigned long long h = mix(seed ^ mix(first2 + j));
+                    x2[j] = (nx + toUniform(h)) / side;
+                    y2[j] = (ny + toUniform(mix(h))) / side;
+                }
+
+                for (long long i = 0; i < size1; ++i)
+                {
+                    for (long long j = (d == 4 ? i + 1 : 0); j < size2; ++j)
+                    {
+                        double ddx = x1[i] - x2[j];
+                        double ddy = y1[i] - y2[j];
+                        if (ddx * ddx + ddy * ddy < radius2)
+                            sink.edge(first1 + i, first2 + j);
+                    }
+                }
+            }
+        }
+        row.swap(nextRow);
+    }
+}
+
+/**
+ * Power-law graph in the Chung-Lu model: vertex i has weight proportional to
+ * (i + 1)^(-1 / (exponent - 1)), scaled to the given average degree, and
+ * vertices u and v are adjacent with probability min(1, w_u w_v / S), where
+ * S is the sum of weights. Weights decrease with the vertex id, so pairs are
+ * skipped with the probability of the last edge and then accepted with the
+ * ratio of probabilities (Miller and Hagberg).
+ */
+void generatePowerLaw(long long n, double averageDegree, double exponent,
+        unsigned long long seed, EdgeSink& sink)
+{
+    Random random(seed);
+    double alpha = 1 / (exponent - 1);
+
+    double sum = 0;
+    for (long long i = 0; i < n; ++i) sum += std::pow(i + 1.0, -alpha);
+    double scale = n * averageDegree / sum;
+    double totalWeight = n * averageDegree;
+
+    for (long long u = 0; u + 1 < n; ++u)
+    {
+        double wu = scale * std::pow(u + 1.0, -alpha);
+        long long v = u + 1;
+        double p = std::min(1.0, wu * scale * std::pow(v + 1.0, -alpha) / totalWeight);
+        while (v < n && p > 0)
+        {
+            v += random.skip(p);
+            if (v >= n) break;
+            double q = std::min(1.0, wu * scale * std::pow(v + 1.0, -alpha) / totalWeight);
+            if (random.uniform() < q / p) sink.edge(u, v);
+            p = q;
+            ++v;
+        }
+    }
+}
+
+/**
+ * Streams the selected model into the sink.
+ */
+void generate(const std::string& model, long long n, double* params,
+        unsigned long long seed, EdgeSink& sink)
+{
+    if (model.compare("gnp") == 0)
+        generateUniform(n, params[0], 0, seed, sink);
+    else if (model.compare("leighton") == 0)
+        generateUniform(n, params[1], (int) params[0], seed, sink);
+    else if (model.compare("geometric") == 0)
+        generateGeometric(n, params[0], seed, sink);
+    else if (model.compare("powerlaw") == 0)
+        generatePowerLaw(n, params[0], params[1], seed, sink);
+}
+
+void printUsage(const char* programName)
+{
+    std::cerr << "Usage: " << programName << " MODEL NUM_VERTICES PARAMS... SEED" << std::endl;
+    std::cerr << "  gnp NUM_VERTICES DENSITY SEED" << std::endl;
+    std::cerr << "  leighton NUM_VERTICES K DENSITY SEED" << std::endl;
+    std::cerr << "  geometric NUM_VERTICES RADIUS SEED" << std::endl;
+    std::cerr << "  powerlaw NUM_VERTICES AVERAGE_DEGREE EXPONENT SEED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string model(argv[1]);
+
+    int numParams = -1;
+    if (model.compare("gnp") == 0) numParams = 1;
+    else if (model.compare("leighton") == 0) numParams = 2;
+    else if (model.compare("geometric") == 0) numParams = 1;
+    else if (model.compare("powerlaw") == 0) numParams = 2;
+    if (numParams == -1 || argc != numParams + 4)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    long long n = atoll(argv[2]);
+    double params[2];
+    for (int i = 0; i < numParams; ++i) params[i] = atof(argv[3 + i]);
+    unsigned long long seed = strtoull(argv[argc - 1], NULL, 10);
+
+    if (model.compare("leighton") == 0 && (params[0] < 1 || params[0] > n))
+    {
+        std::cerr << "K must be between 1 and the number of vertices" << std::endl;
+        return 1;
+    }
+    if (model.compare("geometric") == 0 && (params[0] <= 0 || params[0] > 1))
+    {
+        std::cerr << "RADIUS must be in (0, 1]" << std::endl;
+        return 1;
+    }
+    if (model.compare("powerlaw") == 0 && params[1] <= 1)
+    {
+        std::cerr << "EXPONENT must be greater than 1" << std::endl;
+        return 1;
+    }
+
+    std::ios::sync_with_stdio(false);
+
+    EdgeSink counter(false);
+    generate(model, n, params, seed, counter);
+
+    std::cout << "c Generated by:";
+    for (int i = 0; i < argc; ++i) std::cout << " " << argv[i];
+    std::cout << '\n';
+    std::cout << "p edge " << n << " " << counter.count << '\n';
+
+    EdgeSink writer(true);
+    generate(model, n, params, seed, writer);
+    std::cout.flush();
+
+    return 0;
+}
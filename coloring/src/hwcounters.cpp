@@ -0,0 +1,172 @@
+#include "hwcounters.h"
+
+#ifdef __linux__
+#include <memory>
+#include <cstring>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// Set once by the driver, before any thread starts
+bool hwCountersEnabled = false;
+
+HwCounts::HwCounts()
+{
+    for (int i = 0; i < NUM_HW_EVENTS; ++i) events[i] = 0;
+}
+
+#ifdef __linux__
+
+/**
+ * Group of counters opened with perf_event_open for one thread, so that all
+ * events are read at once. Counting starts when the group is opened and the
+ * descriptors are closed when the thread exits. When there are more events
+ * than hardware counters, the kernel multiplexes the group, and the counts
+ * are scaled up by the ratio of the time it was enabled to the time it was
+ * running, as perf stat does.
+ */
+struct PerfGroup
+{
+    int leader;
+    int fds[NUM_HW_EVENTS];
+
+    // Position of each event among the values read from the group, or -1
+    int index[NUM_HW_EVENTS];
+    int numOpen;
+
+    PerfGroup() : leader(-1), numOpen(0)
+    {
+        static const unsigned long long configs[NUM_HW_EVENTS] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        for (int i = 0; i < NUM_HW_EVENTS; ++i)
+        {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.read_format = PERF_FORMAT_GROUP
+                    | PERF_FORMAT_TOTAL_TIME_ENABLED
+                    | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            // Measure the calling thread on any CPU
+            fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+            if (fds[i] == -1)
+            {
+                index[i] = -1;
+                continue;
+            }
+            if (leader == -1) leader = fds[i];
+            index[i] = numOpen++;
+        }
+    }
+
+    ~PerfGroup()
+    {
+        for (int i = 0; i < NUM_HW_EVENTS; ++i)
+        {
+            if (fds[i] != -1) close(fds[i]);
+        }
+    }
+
+    // Values read are the number of events, the times enabled and running,
+    // and then the count of each event
+    void read(HwCounts& counts)
+    {
+        unsigned long long values[NUM_HW_EVENTS + 3];
+        bool ok = leader != -1
+                && ::read(leader, values, sizeof(values)) > 0
+                && values[2] > 0;
+        double scale = ok ? (double) values[1] / values[2] : 0;
+        for (int i = 0; i < NUM_HW_EVENTS; ++i)
+        {
+            counts.events[i] = (ok && index[i] != -1)
+                    ? (long long) (values[3 + index[i]] * scale) : -1;
+        }
+    }
+};
+
+thread_local std::unique_ptr<PerfGroup> perfGroup;
+
+/**
+ * Enables hardware counters, returning false if they are not available.
+ */
+bool hwcounters_enable()
+{
+    PerfGroup probe;
+    hwCountersEnabled = probe.leader != -1;
+    return hwCountersEnabled;
+}
+
+/**
+ * Reads the counters of the current thread, opening them on first use.
+ */
+void hwcounters_read(HwCounts& counts)
+{
+    if (!hwCountersEnabled) return;
+    if (!perfGroup) perfGroup.reset(new PerfGroup());
+    perfGroup->read(counts);
+}
+
+#else
+
+bool hwcounters_enable()
+{
+    return false;
+}
+
+void hwcounters_read(HwCounts& counts)
+{
+}
+
+#endif
+
+bool hwcounters_enabled()
+{
+    return hwCountersEnabled;
+}
+
+/**
+ * Turns counts into the difference from the start counts.
+ */
+void hwcounters_subtract(HwCounts& counts, const HwCounts& start)
+{
+    for (int i = 0; i < NUM_HW_EVENTS; ++i)
+    {
+        if (counts.events[i] != -1 && start.events[i] != -1)
+            counts.events[i] -= start.events[i];
+        else
+            counts.events[i] = -1;
+    }
+}
+
+void hwcounters_add(HwCounts& counts, const HwCounts& delta)
+{
+    for (int i = 0; i < NUM_HW_EVENTS; ++i)
+    {
+        if (counts.events[i] != -1 && delta.events[i] != -1)
+            counts.events[i] += delta.events[i];
+        else
+            counts.events[i] = -1;
+    }
+}
+
+/**
+ * Writes the counts as cycles/instructions/cache misses/branch misses.
+ */
+void hwcounters_print(std::ostream& out, const HwCounts& counts)
+{
+    for (int i = 0; i < NUM_HW_EVENTS; ++i)
+    {
+        if (i > 0) out << "/";
+        out << counts.events[i];
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef HWCOUNTERS_H_
+#define HWCOUNTERS_H_
+
+#include <iostream>
+
+// Cycles, instructions, cache misses and branch misses
+#define NUM_HW_EVENTS 4
+
+/**
+ * Hardware event counts of the current thread, in user space. Events that
+ * could not be counted are -1.
+ */
+struct HwCounts
+{
+    long long events[NUM_HW_EVENTS];
+
+    HwCounts();
+};
+
+bool hwcounters_enable();
+bool hwcounters_enabled();
+
+void hwcounters_read(HwCounts& counts);
+void hwcounters_subtract(HwCounts& counts, const HwCounts& start);
+void hwcounters_add(HwCounts& counts, const HwCounts& delta);
+void hwcounters_print(std::ostream& out, const HwCounts& counts);
+
+#endif /*HWCOUNTERS_H_*/
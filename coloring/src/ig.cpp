@@ -0,0 +1,170 @@
+#include "ig.h"
+#include "dsatur.h"
+#include "ts.h"
+#include "timing.h"
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+// Passes without using fewer colors before giving up
+#define MAX_STALLED_PASSES 1000
+
+// Out of 10 passes, how many reverse the classes and how many take the
+// largest first; the others shuffle them
+#define REVERSE_WEIGHT 5
+#define LARGEST_FIRST_WEIGHT 3
+
+/**
+ * Buffers of the iterated greedy, allocated once for all passes.
+ */
+struct GreedyBuffers
+{
+    // Vertices in the order they are colored in the next pass
+    std::vector<int> order;
+    
+    // Color classes in the order they are visited, and their sizes
+    std::vector<int> classOrder;
+    std::vector<int> classSize;
+    std::vector<int> classStart;
+    
+    // forbidden[c] == stamp if color c is used by a neighbor of the vertex
+    // being colored
+    std::vector<unsigned int> forbidden;
+    unsigned int stamp;
+};
+
+/**
+ * Compares color classes by decreasing size.
+ */
+struct LargerClass
+{
+    const std::vector<int>& classSize;
+    
+    LargerClass(const std::vector<int>& classSize) : classSize(classSize) {}
+    
+    bool operator()(int c1, int c2) const
+    {
+        return classSize[c1] > classSize[c2];
+    }
+};
+
+/**
+ * Lays out the vertices class by class, with the classes in a new order:
+ * reversed, largest first or shuffled.
+ */
+void reorderClasses(const Solution& solution, int k, GreedyBuffers& buffers)
+{
+    int n = solution.instance->nvertices;
+    std::fill(buffers.classSize.begin(), buffers.classSize.begin() + k, 0);
+    for (int u = 0; u < n; ++u) buffers.classSize[solution.coloring[u]]++;
+    
+    for (int c = 0; c < k; ++c) buffers.classOrder[c] = k - 1 - c;
+    int strategy = tsRandom(10);
+    if (strategy >= REVERSE_WEIGHT + LARGEST_FIRST_WEIGHT)
+    {
+        std::shuffle(buffers.classOrder.begin(),
+                buffers.classOrder.begin() + k, tsRandom);
+    }
+    else if (strategy >= REVERSE_WEIGHT)
+    {
+        std::stable_sort(buffers.classOrder.begin(),
+                buffers.classOrder.begin() + k, LargerClass(buffers.classSize));
+    }
+    
+    int start = 0;
+    for (int i = 0; i < k; ++i)
+    {
+        int c = buffers.classOrder[i];
+        buffers.classStart[c] = start;
+        start += buffers.classSize[c];
+    }
+    for (int u = 0; u < n; ++u)
+        buffers.order[buffers.classStart[solution.coloring[u]]++] = u;
+}
+
+/**
+ * Colors the vertices greedily in the order of the buffer, giving each the
+ * smallest color not used by its neighbors. Vertices of the same class are
+ * never adjacent, so a class is never spread over more colors than there are
+ * classes before it: the pass does not use more colors. Returns the number
+ * of colors used.
+ */
+int greedyPass(Solution& solution, GreedyBuffers& buffers)
+{
+    int n = solution.instance->nvertices;
+    for (int u = 0; u < n; ++u) solution.coloring[u] = -1;
+    
+    int k = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        int u = buffers.order[i];
+        if (++buffers.stamp == 0)
+        {
+            std::fill(buffers.forbidden.begin(), buffers.forbidden.end(), 0);
+            buffers.stamp = 1;
+        }
+        
+        // Gets adjacency of vertex u
+        int* adj = solution.instance->gamma[u];
+        
+        // Iteration starts on index 1 and ends adj[0] indices after the start
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            int color = solution.coloring[*it];
+            if (color != -1) buffers.forbidden[color] = buffers.stamp;
+        }
+        
+        int color = 0;
+        while (buffers.forbidden[color] == buffers.stamp) ++color;
+        solution.coloring[u] = color;
+        k = std::max(k, color + 1);
+    }
+    return k;
+}
+
+/**
+ * Iterated greedy (Culberson): starting from DSATUR, repeatedly recolors the
+ * vertices greedily with the color classes of the previous pass in a new
+ * order. The number of colors never increases, and each pass costs O(n + m).
+ * Stops after MAX_STALLED_PASSES passes without improvement.
+ */
+void ig_constructSolution(Instance* instance, Solution* solution)
+{
+    int n = instance->nvertices;
+    Solution current(instance);
+    dsatur_constructSolution(instance, &current);
+    
+    // DSATUR colors from 0 on without gaps
+    int k = 0;
+    for (int u = 0; u < n; ++u) k = std::max(k, current.coloring[u] + 1);
+    
+    GreedyBuffers buffers;
+    buffers.order.resize(n);
+    buffers.classOrder.resize(k);
+    buffers.classSize.resize(k);
+    buffers.classStart.resize(k);
+    buffers.forbidden.assign(k + 1, 0);
+    buffers.stamp = 0;
+    
+    PhaseStart round;
+    timing_beginPhase(round);
+    int passes = 0;
+    for (int stalled = 0; stalled < MAX_STALLED_PASSES && k > 1; ++stalled)
+    {
+        reorderClasses(current, k, buffers);
+        int newK = greedyPass(current, buffers);
+        passes++;
+        if (newK < k)
+        {
+            // Record the time taken to get below k colors
+            timing_addRound(k - 1, round, passes);
+            timing_beginPhase(round);
+            passes = 0;
+            k = newK;
+            stalled = -1;
+        }
+    }
+    if (passes > 0) timing_addRound(k - 1, round, passes);
+    
+    for (int u = 0; u < n; ++u) solution->coloring[u] = current.coloring[u];
+}
@@ -0,0 +1,8 @@
+#ifndef IG_H_
+#define IG_H_
+
+#include "coloring.h"
+
+void ig_constructSolution(Instance* instance, Solution* solution);
+
+#endif /*IG_H_*/
@@ -0,0 +1,468 @@
+#include "incremental.h"
+#include "ts.h"
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <sstream>
+#include <string>
+
+// Vertices around the changed ones that the local search may recolor
+#define MIN_REGION_SIZE 256
+#define REGION_SIZE_PER_SEED 32
+
+// Iterations of the local search per vertex in the region
+#define ITERATIONS_PER_REGION_VERTEX 200
+
+GraphUpdate::GraphUpdate() :
+    numNewVertices(0)
+{
+}
+
+/**
+ * Takes k from the largest color, since the searches index their counts by
+ * color and a coloring may skip some.
+ */
+IncrementalState::IncrementalState(Instance* instance, Solution* solution) :
+    k(1), capacity(instance->nvertices)
+{
+    for (int u = 0; u < instance->nvertices; ++u)
+        k = std::max(k, solution->coloring[u] + 1);
+}
+
+/**
+ * Appends isolated, uncolored vertices to the instance and the solution.
+ * The arrays are reallocated at twice the size needed when they are full,
+ * so that adding vertices takes amortized constant time per vertex.
+ */
+void addVertices(Instance* instance, Solution* solution, int numNewVertices,
+        int& capacity)
+{
+    int numVertices = instance->nvertices;
+    int newNumVertices = numVertices + numNewVertices;
+
+    if (newNumVertices > capacity)
+    {
+        capacity = 2 * newNumVertices;
+        int** gamma = new int*[capacity];
+        int* coloring = new int[capacity];
+        std::copy(instance->gamma, instance->gamma + numVertices, gamma);
+        std::copy(solution->coloring, solution->coloring + numVertices, coloring);
+        delete[] instance->gamma;
+        delete[] solution->coloring;
+        instance->gamma = gamma;
+        solution->coloring = coloring;
+    }
+    for (int i = numVertices; i < newNumVertices; ++i)
+    {
+        instance->gamma[i] = new int[1];
+        instance->gamma[i][0] = 0;
+        solution->coloring[i] = -1;
+    }
+    instance->nvertices = newNumVertices;
+}
+
+/**
+ * Removes all occurrences of v from the adjacency of u, returning whether
+ * there was any. The array keeps its size, only its count is decremented.
+ */
+bool removeNeighbor(Instance* instance, int u, int v)
+{
+    int* adj = instance->gamma[u];
+    bool found = false;
+    for (int i = 1; i <= adj[0]; )
+    {
+        if (adj[i] == v)
+        {
+            adj[i] = adj[adj[0]];
+            --adj[0];
+            found = true;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return found;
+}
+
+bool hasNeighbor(Instance* instance, int u, int v)
+{
+    int* adj = instance->gamma[u];
+    return std::find(adj + 1, adj + 1 + adj[0], v) != (adj + 1 + adj[0]);
+}
+
+/**
+ * Adds the new edges, reallocating the adjacency of each endpoint once.
+ * Edges that already exist are ignored. The endpoints of the added edges are
+ * appended to touched.
+ */
+void addEdges(Instance* instance,
+        const std::vector<std::pair<int, int> >& edges,
+        std::vector<int>& touched)
+{
+    std::set<std::pair<int, int> > added;
+    std::unordered_map<int, std::vector<int> > newNeighbors;
+    for (unsigned int i = 0; i < edges.size(); ++i)
+    {
+        int u = std::min(edges[i].first, edges[i].second);
+        int v = std::max(edges[i].first, edges[i].second);
+        if (u == v || hasNeighbor(instance, u, v)) continue;
+        if (!added.insert(std::make_pair(u, v)).second) continue;
+
+        newNeighbors[u].push_back(v);
+        newNeighbors[v].push_back(u);
+        touched.push_back(u);
+        touched.push_back(v);
+        ++instance->nedges;
+    }
+
+    for (std::unordered_map<int, std::vector<int> >::iterator it = newNeighbors.begin();
+            it != newNeighbors.end(); ++it)
+    {
+        int u = it->first;
+        std::vector<int>& neighbors = it->second;
+        int* adj = instance->gamma[u];
+        int* newAdj = new int[adj[0] + neighbors.size() + 1];
+        std::copy(adj, adj + 1 + adj[0], newAdj);
+        std::copy(neighbors.begin(), neighbors.end(), newAdj + 1 + adj[0]);
+        newAdj[0] += neighbors.size();
+        delete[] adj;
+        instance->gamma[u] = newAdj;
+    }
+}
+
+/**
+ * Returns the color in [0, k) with fewest neighbors of u, preferring the
+ * smallest one. counts must have k zeroed positions and is left zeroed.
+ */
+int leastConflictingColor(Instance* instance, Solution* solution, int u,
+        int k, std::vector<int>& counts)
+{
+    int* adj = instance->gamma[u];
+    for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+    {
+        int color = solution->coloring[*it];
+        if (color != -1) ++counts[color];
+    }
+
+    int bestColor = 0;
+    for (int color = 1; color < k; ++color)
+    {
+        if (counts[color] < counts[bestColor]) bestColor = color;
+    }
+
+    for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+    {
+        int color = solution->coloring[*it];
+        if (color != -1) counts[color] = 0;
+    }
+    return bestColor;
+}
+
+bool hasConflict(Instance* instance, Solution* solution, int u)
+{
+    int* adj = instance->gamma[u];
+    for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+    {
+        if (solution->coloring[*it] == solution->coloring[u]) return true;
+    }
+    return false;
+}
+
+/**
+ * Collects the vertices within distance two of the seeds, breadth first,
+ * until the size limit is reached.
+ */
+void buildRegion(Instance* instance, const std::vector<int>& seeds,
+        std::vector<int>& region, std::unordered_map<int, int>& localId)
+{
+    unsigned int limit = std::max((unsigned int) MIN_REGION_SIZE,
+            (unsigned int) (REGION_SIZE_PER_SEED * seeds.size()));
+    for (unsigned int i = 0; i < seeds.size(); ++i)
+    {
+        if (localId.insert(std::make_pair(seeds[i], (int) region.size())).second)
+            region.push_back(seeds[i]);
+    }
+
+    unsigned int levelStart = 0;
+    for (int distance = 0; distance < 2; ++distance)
+    {
+        unsigned int levelEnd = region.size();
+        for (unsigned int i = levelStart; i < levelEnd; ++i)
+        {
+            int* adj = instance->gamma[region[i]];
+            for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+            {
+                if (region.size() >= limit) return;
+                if (localId.insert(std::make_pair(*it, (int) region.size())).second)
+                    region.push_back(*it);
+            }
+        }
+        levelStart = levelEnd;
+    }
+}
+
+/**
+ * Keeps the list of conflicting region vertices up to date for vertex i.
+ */
+void updateConflicting(int i, bool inConflict, std::vector<int>& conflicting,
+        std::vector<int>& position)
+{
+    if (inConflict && position[i] == -1)
+    {
+        position[i] = conflicting.size();
+        conflicting.push_back(i);
+    }
+    else if (!inConflict && position[i] != -1)
+    {
+        int last = conflicting.back();
+        conflicting[position[i]] = last;
+        position[last] = position[i];
+        conflicting.pop_back();
+        position[i] = -1;
+    }
+}
+
+/**
+ * Tabu search with k colors that only recolors the vertices of the region.
+ * Vertices outside the region keep their colors, so color counts are only
+ * kept for the region and the work does not depend on the graph size. The
+ * best coloring found is left in the solution.
+ */
+void localTabuSearch(Instance* instance, Solution* solution,
+        const std::vector<int>& region,
+        const std::unordered_map<int, int>& localId, int k)
+{
+    int size = region.size();
+    int* coloring = solution->coloring;
+
+    // counts[i * k + c] is the number of neighbors of region[i] with color c
+    std::vector<int> counts(size * k, 0);
+    int value = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        int u = region[i];
+        int* adj = instance->gamma[u];
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            int v = *it;
+            ++counts[i * k + coloring[v]];
+
+            // Count each conflicting edge once
+            if (coloring[v] == coloring[u]
+                    && (u < v || localId.find(v) == localId.end()))
+                ++value;
+        }
+    }
+
+    // Region vertices in conflict, with their positions in the list
+    std::vector<int> conflicting;
+    std::vector<int> position(size, -1);
+    for (int i = 0; i < size; ++i)
+    {
+        updateConflicting(i, counts[i * k + coloring[region[i]]] > 0,
+                conflicting, position);
+    }
+
+    std::vector<int> bestColors(size);
+    for (int i = 0; i < size; ++i) bestColors[i] = coloring[region[i]];
+    int bestValue = value;
+
+    std::vector<int> tabuUntil(size * k, 0);
+    int maxIt = ITERATIONS_PER_REGION_VERTEX * size;
+    for (int it = 1; it <= maxIt && bestValue > 0; ++it)
+    {
+        // Best non-tabu move, or tabu move improving the best value
+        int bestI = -1, bestColor = -1, bestDelta = 0, numTies = 0;
+        for (unsigned int j = 0; j < conflicting.size(); ++j)
+        {
+            int i = conflicting[j];
+            int* count = &counts[i * k];
+            int currentColor = coloring[region[i]];
+            for (int color = 0; color < k; ++color)
+            {
+                if (color == currentColor) continue;
+                int delta = count[color] - count[currentColor];
+                if (tabuUntil[i * k + color] >= it && value + delta >= bestValue)
+                    continue;
+                if (bestI == -1 || delta < bestDelta)
+                {
+                    bestI = i;
+                    bestColor = color;
+                    bestDelta = delta;
+                    numTies = 1;
+                }
+                else if (delta == bestDelta && tsRandom(++numTies) == 0)
+                {
+                    bestI = i;
+                    bestColor = color;
+                }
+            }
+        }
+        if (bestI == -1) continue;
+
+        // Apply move, updating counts and conflicting vertices in the region
+        int u = region[bestI];
+        int oldColor = coloring[u];
+        coloring[u] = bestColor;
+        value += bestDelta;
+        int* adj = instance->gamma[u];
+        for (int *it2 = (adj + 1), *end = (it2 + adj[0]); it2 != end; ++it2)
+        {
+            std::unordered_map<int, int>::const_iterator found = localId.find(*it2);
+            if (found == localId.end()) continue;
+            int i = found->second;
+            --counts[i * k + oldColor];
+            ++counts[i * k + bestColor];
+            updateConflicting(i, counts[i * k + coloring[*it2]] > 0,
+                    conflicting, position);
+        }
+        updateConflicting(bestI, counts[bestI * k + bestColor] > 0,
+                conflicting, position);
+
+        tabuUntil[bestI * k + oldColor] = it + tsRandom(10)
+                + (6 * conflicting.size()) / 10;
+
+        if (value < bestValue)
+        {
+            bestValue = value;
+            for (int i = 0; i < size; ++i) bestColors[i] = coloring[region[i]];
+        }
+    }
+
+    for (int i = 0; i < size; ++i) coloring[region[i]] = bestColors[i];
+}
+
+/**
+ * Applies the update to the instance and repairs the coloring around the
+ * changed vertices. Uncolored and conflicting vertices first take their
+ * least conflicting color among the k colors in use, remaining conflicts are
+ * handled by a bounded tabu search around them, and as a last resort
+ * vertices still in conflict take new colors. The solution stays legal and
+ * the work is proportional to the size of the change, with the arrays of
+ * vertices growing in amortized constant time per new vertex.
+ */
+void incremental_updateSolution(Instance* instance, Solution* solution,
+        const GraphUpdate& update, IncrementalState& state)
+{
+    int& k = state.k;
+    if (update.numNewVertices > 0)
+        addVertices(instance, solution, update.numNewVertices, state.capacity);
+
+    for (unsigned int i = 0; i < update.removedEdges.size(); ++i)
+    {
+        int u = update.removedEdges[i].first;
+        int v = update.removedEdges[i].second;
+        if (removeNeighbor(instance, u, v))
+        {
+            removeNeighbor(instance, v, u);
+            --instance->nedges;
+        }
+    }
+    for (unsigned int i = 0; i < update.removedVertices.size(); ++i)
+    {
+        int u = update.removedVertices[i];
+        int* adj = instance->gamma[u];
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            removeNeighbor(instance, *it, u);
+        }
+        instance->nedges -= adj[0];
+        adj[0] = 0;
+    }
+
+    // Only new vertices and endpoints of new edges may be in conflict
+    std::vector<int> touched;
+    for (int i = 0; i < update.numNewVertices; ++i)
+    {
+        touched.push_back(instance->nvertices - update.numNewVertices + i);
+    }
+    addEdges(instance, update.addedEdges, touched);
+
+    std::vector<int> counts(k, 0);
+    std::vector<int> seeds;
+    for (unsigned int i = 0; i < touched.size(); ++i)
+    {
+        int u = touched[i];
+        if (solution->coloring[u] != -1 && !hasConflict(instance, solution, u))
+            continue;
+        solution->coloring[u] = leastConflictingColor(instance, solution, u,
+                k, counts);
+        if (hasConflict(instance, solution, u)) seeds.push_back(u);
+    }
+    if (seeds.empty()) return;
+
+    std::vector<int> region;
+    std::unordered_map<int, int> localId;
+    buildRegion(instance, seeds, region, localId);
+    localTabuSearch(instance, solution, region, localId, k);
+
+    // Conflicts only involve region vertices, so recoloring these with their
+    // smallest free color leaves the solution legal
+    for (unsigned int i = 0; i < region.size(); ++i)
+    {
+        int u = region[i];
+        if (!hasConflict(instance, solution, u)) continue;
+
+        std::set<int> usedColors;
+        int* adj = instance->gamma[u];
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            usedColors.insert(solution->coloring[*it]);
+        }
+        int color = 0;
+        while (usedColors.count(color) > 0) ++color;
+        solution->coloring[u] = color;
+        k = std::max(k, color + 1);
+    }
+}
+
+bool incremental_readUpdates(std::istream& in, int numVertices,
+        std::vector<GraphUpdate>& updates)
+{
+    GraphUpdate update;
+    bool empty = true;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string kind;
+        if (!(fields >> kind) || kind[0] == 'c') continue;
+
+        int u = 0, v = 0;
+        if (kind == "b")
+        {
+            updates.push_back(update);
+            update = GraphUpdate();
+            empty = true;
+            continue;
+        }
+        else if (kind == "v")
+        {
+            if (!(fields >> u) || u < 0) return false;
+            update.numNewVertices += u;
+            numVertices += u;
+        }
+        else if (kind == "x")
+        {
+            if (!(fields >> u) || u < 1 || u > numVertices) return false;
+            update.removedVertices.push_back(u - 1);
+        }
+        else if (kind == "a" || kind == "r")
+        {
+            if (!(fields >> u >> v) || u < 1 || u > numVertices || v < 1
+                    || v > numVertices || u == v)
+                return false;
+            std::vector<std::pair<int, int> >& edges =
+                    (kind == "a") ? update.addedEdges : update.removedEdges;
+            edges.push_back(std::make_pair(u - 1, v - 1));
+        }
+        else
+        {
+            return false;
+        }
+        empty = false;
+    }
+    if (!empty) updates.push_back(update);
+    return !in.bad();
+}
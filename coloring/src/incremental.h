@@ -0,0 +1,60 @@
+#ifndef INCREMENTAL_H_
+#define INCREMENTAL_H_
+
+#include <vector>
+#include <utility>
+#include <istream>
+
+#include "coloring.h"
+
+/**
+ * Batch of changes to a colored graph. New vertices get the ids following
+ * the current ones. Removed vertices keep their ids, but lose all their
+ * edges. Vertex ids are zero-based.
+ */
+struct GraphUpdate
+{
+    int numNewVertices;
+    std::vector<int> removedVertices;
+    std::vector<std::pair<int, int> > addedEdges;
+    std::vector<std::pair<int, int> > removedEdges;
+
+    GraphUpdate();
+};
+
+/**
+ * What the updates of a colored graph keep from one batch to the next: k,
+ * above every color of the solution, and the number of vertices the arrays
+ * of the instance and the solution have room for.
+ */
+struct IncrementalState
+{
+    int k;
+    int capacity;
+
+    IncrementalState(Instance* instance, Solution* solution);
+};
+
+/**
+ * Applies the update and recolors the vertices it left uncolored or in
+ * conflict, keeping the solution legal. k grows if the update could not be
+ * colored with it.
+ */
+void incremental_updateSolution(Instance* instance, Solution* solution,
+        const GraphUpdate& update, IncrementalState& state);
+
+/**
+ * Reads batches of updates of a graph with the given number of vertices,
+ * one change per line with one-based vertex ids:
+ *   v COUNT   adds COUNT vertices
+ *   x U       removes vertex U
+ *   a U V     adds edge U-V
+ *   r U V     removes edge U-V
+ *   b         ends the batch
+ * Lines starting with c are comments, and a last batch needs no b line.
+ * Returns false on a malformed line or an unknown vertex.
+ */
+bool incremental_readUpdates(std::istream& in, int numVertices,
+        std::vector<GraphUpdate>& updates);
+
+#endif /*INCREMENTAL_H_*/
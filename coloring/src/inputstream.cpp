@@ -0,0 +1,252 @@
+#include "inputstream.h"
+#include <iostream>
+#include <ios>
+#include <cstdio>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+// The ring holds NUM_BLOCKS blocks of BLOCK_SIZE decompressed bytes
+#define NUM_BLOCKS 4
+#define BLOCK_SIZE (1 << 18)
+
+/**
+ * Returns whether the name ends with the given suffix.
+ */
+bool endsWith(const std::string& name, const std::string& suffix)
+{
+    return name.size() >= suffix.size()
+            && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+class GzipSource : public DecompressingSource
+{
+public:
+    GzipSource(gzFile file) : file(file) {}
+    ~GzipSource() { gzclose(file); }
+
+    // A truncated file ends without an error from gzread, only in gzerror
+    long read(char* buffer, long size)
+    {
+        long read = gzread(file, buffer, size);
+        if (read == 0)
+        {
+            int error;
+            gzerror(file, &error);
+            if (error != Z_OK) return -1;
+        }
+        return read;
+    }
+
+private:
+    gzFile file;
+};
+
+#ifdef HAVE_ZSTD
+class ZstdSource : public DecompressingSource
+{
+public:
+    ZstdSource(FILE* file) :
+        file(file), stream(ZSTD_createDStream()),
+        compressed(ZSTD_DStreamInSize()), lastResult(0)
+    {
+        ZSTD_initDStream(stream);
+        input.src = &compressed[0];
+        input.size = 0;
+        input.pos = 0;
+    }
+
+    ~ZstdSource()
+    {
+        ZSTD_freeDStream(stream);
+        fclose(file);
+    }
+
+    // The file may only end where a frame does, when the last result of
+    // the decoder was 0. Past the end of the file, the decoder still flushes
+    // what it holds, and a frame left incomplete means it was truncated.
+    long read(char* buffer, long size)
+    {
+        ZSTD_outBuffer output = { buffer, (size_t) size, 0 };
+        while (output.pos == 0)
+        {
+            if (input.pos == input.size)
+            {
+                input.size = fread(&compressed[0], 1, compressed.size(), file);
+                input.pos = 0;
+                if (input.size == 0 && lastResult == 0) return 0;
+            }
+            size_t result = ZSTD_decompressStream(stream, &output, &input);
+            if (ZSTD_isError(result)) return -1;
+            if (input.size == 0 && output.pos == 0) return -1;
+            lastResult = result;
+        }
+        return output.pos;
+    }
+
+private:
+    FILE* file;
+    ZSTD_DStream* stream;
+    std::vector<char> compressed;
+    ZSTD_inBuffer input;
+    size_t lastResult;
+};
+#endif
+
+DecompressingBuffer::DecompressingBuffer(DecompressingSource* source) :
+    source(source), blocks(NUM_BLOCKS, std::vector<char>(BLOCK_SIZE)),
+    sizes(NUM_BLOCKS, 0), nextFilled(0), nextRead(0), numFilled(0),
+    reading(false), finished(false), failed(false), stopping(false)
+{
+    decompressor = std::thread(&DecompressingBuffer::decompress, this);
+}
+
+DecompressingBuffer::~DecompressingBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    decompressor.join();
+    delete source;
+}
+
+/**
+ * Decompressor loop: fills the next free block, waiting while the ring is
+ * full. Blocks from nextRead on are only touched by the reader.
+ */
+void DecompressingBuffer::decompress()
+{
+    while (true)
+    {
+        int block;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (numFilled == NUM_BLOCKS && !stopping) changed.wait(lock);
+            if (stopping) return;
+            block = nextFilled;
+        }
+
+        long size = source->read(&blocks[block][0], BLOCK_SIZE);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (size <= 0)
+            {
+                finished = true;
+                failed = (size < 0);
+            }
+            else
+            {
+                sizes[block] = size;
+                nextFilled = (nextFilled + 1) % NUM_BLOCKS;
+                numFilled++;
+            }
+        }
+        changed.notify_all();
+        if (size <= 0) return;
+    }
+}
+
+/**
+ * Releases the block just read and moves to the next one, waiting for the
+ * decompressor if needed. The istream catches the exception thrown after a
+ * decoding error and sets badbit instead of eofbit.
+ */
+DecompressingBuffer::int_type DecompressingBuffer::underflow()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (reading)
+    {
+        reading = false;
+        nextRead = (nextRead + 1) % NUM_BLOCKS;
+        numFilled--;
+        changed.notify_all();
+    }
+    while (numFilled == 0 && !finished) changed.wait(lock);
+    if (numFilled == 0 && failed)
+        throw std::ios_base::failure("Error decompressing input");
+    if (numFilled == 0) return traits_type::eof();
+
+    reading = true;
+    char* block = &blocks[nextRead][0];
+    setg(block, block, block + sizes[nextRead]);
+    return traits_type::to_int_type(*gptr());
+}
+
+InputStream::InputStream() :
+    std::istream(NULL), decompressing(NULL)
+{
+}
+
+InputStream::~InputStream()
+{
+    close();
+}
+
+/**
+ * Opens the file, decompressing it on a separate thread if its name ends in
+ * a compression suffix.
+ */
+void InputStream::open(const std::string& fileName)
+{
+    close();
+    DecompressingSource* source = NULL;
+    if (endsWith(fileName, ".gz"))
+    {
+        gzFile gz = gzopen(fileName.c_str(), "rb");
+        if (gz != NULL)
+        {
+            gzbuffer(gz, BLOCK_SIZE);
+            source = new GzipSource(gz);
+        }
+    }
+    else if (endsWith(fileName, ".zst"))
+    {
+#ifdef HAVE_ZSTD
+        FILE* zst = fopen(fileName.c_str(), "rb");
+        if (zst != NULL) source = new ZstdSource(zst);
+#else
+        std::cerr << "Built without zstd support (make ZSTD=1)" << std::endl;
+#endif
+    }
+    else
+    {
+        if (file.open(fileName.c_str(), std::ios::in) != NULL) rdbuf(&file);
+        else setstate(std::ios::failbit);
+        return;
+    }
+
+    if (source == NULL)
+    {
+        setstate(std::ios::failbit);
+        return;
+    }
+    decompressing = new DecompressingBuffer(source);
+    rdbuf(decompressing);
+}
+
+bool InputStream::is_open() const
+{
+    return file.is_open() || decompressing != NULL;
+}
+
+void InputStream::close()
+{
+    rdbuf(NULL);
+    if (file.is_open()) file.close();
+    delete decompressing;
+    decompressing = NULL;
+}
+
+/**
+ * Returns the file name without a compression suffix.
+ */
+std::string inputstream_stripCompression(const std::string& fileName)
+{
+    if (endsWith(fileName, ".gz")) return fileName.substr(0, fileName.size() - 3);
+    if (endsWith(fileName, ".zst")) return fileName.substr(0, fileName.size() - 4);
+    return fileName;
+}
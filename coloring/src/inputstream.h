@@ -0,0 +1,78 @@
+#ifndef INPUTSTREAM_H_
+#define INPUTSTREAM_H_
+
+#include <istream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * Compressed file read in blocks by a decoder.
+ */
+class DecompressingSource
+{
+public:
+    virtual ~DecompressingSource() {}
+
+    // Returns the number of bytes decoded, 0 at the end or -1 on error
+    virtual long read(char* buffer, long size) = 0;
+};
+
+/**
+ * Stream buffer fed by a thread that decompresses a file into a bounded ring
+ * of blocks, so that decompression overlaps with parsing. A decoding error
+ * sets badbit on the stream once the blocks before it are read.
+ */
+class DecompressingBuffer : public std::streambuf
+{
+public:
+    DecompressingBuffer(DecompressingSource* source);
+    ~DecompressingBuffer();
+
+protected:
+    int_type underflow();
+
+private:
+    void decompress();
+
+    DecompressingSource* source;
+    std::vector<std::vector<char> > blocks;
+    std::vector<long> sizes;
+    int nextFilled;
+    int nextRead;
+    int numFilled;
+    bool reading;
+    bool finished;
+    bool failed;
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread decompressor;
+};
+
+/**
+ * Input file stream, used like std::ifstream, that reads files ending in .gz
+ * (and .zst, when built with HAVE_ZSTD) decompressed on the fly, without
+ * temporary files.
+ */
+class InputStream : public std::istream
+{
+public:
+    InputStream();
+    ~InputStream();
+
+    void open(const std::string& fileName);
+    bool is_open() const;
+    void close();
+
+private:
+    std::filebuf file;
+    DecompressingBuffer* decompressing;
+};
+
+std::string inputstream_stripCompression(const std::string& fileName);
+
+#endif /*INPUTSTREAM_H_*/
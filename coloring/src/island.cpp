@@ -0,0 +1,315 @@
+#include "island.h"
+#include "timing.h"
+#include "ts.h"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sched.h>
+#include <dirent.h>
+#endif
+
+/**
+ * What each island reports back when it finishes.
+ */
+struct IslandStats
+{
+    int k;
+    int imports;
+    int numRounds;
+    long long construction;
+    long long iterations;
+};
+
+/**
+ * Round of the search of an island, as recorded in its timing.
+ */
+struct IslandRound
+{
+    int k;
+    long long time;
+    HwCounts counts;
+};
+
+/**
+ * Header of the shared segment. It is followed by the statistics of each
+ * island, by room for the rounds of each island, and then by the best
+ * coloring, which is guarded by the lock while bestK can be read at any
+ * time. Each round lowers k, so an island has at most one more round than
+ * there are vertices.
+ */
+struct IslandShared
+{
+    std::atomic<bool> locked;
+    std::atomic<int> bestK;
+    int numVertices;
+    int numIslands;
+
+    IslandShared(int numVertices, int numIslands) :
+        locked(false), bestK(INT_MAX), numVertices(numVertices),
+        numIslands(numIslands) {}
+
+    static size_t size(int numVertices, int numIslands)
+    {
+        return sizeof(IslandShared) + numIslands * sizeof(IslandStats)
+                + numIslands * maxRounds(numVertices) * sizeof(IslandRound)
+                + numVertices * sizeof(int);
+    }
+
+    static int maxRounds(int numVertices) { return numVertices + 1; }
+
+    IslandStats* stats() { return reinterpret_cast<IslandStats*>(this + 1); }
+
+    IslandRound* rounds(int island)
+    {
+        return reinterpret_cast<IslandRound*>(stats() + numIslands)
+                + island * maxRounds(numVertices);
+    }
+
+    int* coloring() { return reinterpret_cast<int*>(rounds(numIslands)); }
+
+    void lock()
+    {
+        while (locked.exchange(true, std::memory_order_acquire))
+            sched_yield();
+    }
+
+    void unlock() { locked.store(false, std::memory_order_release); }
+};
+
+// Set in each island process, NULL elsewhere
+IslandShared* islandShared = NULL;
+int islandId = 0;
+int islandMigrationInterval = 1;
+
+/**
+ * Pins the calling process to the CPUs of one NUMA node, taking the nodes in
+ * turn. Nothing is done if the nodes cannot be read.
+ */
+void pinToNode(int island)
+{
+#ifdef __linux__
+    std::vector<int> nodes;
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (dir == NULL) return;
+    for (struct dirent* entry = readdir(dir); entry != NULL; entry = readdir(dir))
+    {
+        int node;
+        char rest;
+        if (sscanf(entry->d_name, "node%d%c", &node, &rest) == 1)
+            nodes.push_back(node);
+    }
+    closedir(dir);
+    if (nodes.empty()) return;
+    std::sort(nodes.begin(), nodes.end());
+
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "/sys/devices/system/node/node%d/cpulist",
+            nodes[island % nodes.size()]);
+    std::ifstream in(fileName);
+    std::string range;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    int numCpus = 0;
+
+    // The list has ranges such as "0-3,8-11"
+    while (std::getline(in, range, ','))
+    {
+        int first, last;
+        int fields = sscanf(range.c_str(), "%d-%d", &first, &last);
+        if (fields < 1) continue;
+        if (fields == 1) last = first;
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+        {
+            CPU_SET(cpu, &cpus);
+            numCpus++;
+        }
+    }
+    if (numCpus > 0) sched_setaffinity(0, sizeof(cpus), &cpus);
+#endif
+}
+
+/**
+ * Trades colorings with the other islands: the solution, which must be
+ * feasible, is published if it uses fewer colors than the shared one, and
+ * replaced by the shared one if that uses fewer. Returns whether the solution
+ * was replaced. Does nothing outside of an island.
+ */
+bool island_exchange(Solution& solution)
+{
+    if (islandShared == NULL) return false;
+
+    int n = solution.instance->nvertices;
+    int k = solution.k();
+    if (k == islandShared->bestK.load(std::memory_order_acquire)) return false;
+
+    bool imported = false;
+    islandShared->lock();
+    int* shared = islandShared->coloring();
+    int bestK = islandShared->bestK.load(std::memory_order_relaxed);
+    if (k < bestK)
+    {
+        // Publish with colors renumbered from 0 in order of appearance
+        std::vector<int> newColor(n, -1);
+        int numColors = 0;
+        for (int u = 0; u < n; ++u)
+        {
+            int& color = newColor[solution.coloring[u]];
+            if (color == -1) color = numColors++;
+            shared[u] = color;
+        }
+        islandShared->bestK.store(k, std::memory_order_release);
+    }
+    else if (bestK < k)
+    {
+        std::copy(shared, shared + n, solution.coloring);
+        islandShared->stats()[islandId].imports++;
+        imported = true;
+    }
+    islandShared->unlock();
+    return imported;
+}
+
+/**
+ * Returns true when a search at the given iteration trying k colors should
+ * stop because another island already has a coloring with at most k colors.
+ * The shared value is only looked at every migration interval.
+ */
+bool island_poll(long long iteration, int k)
+{
+    if (islandShared == NULL || iteration % islandMigrationInterval != 0)
+        return false;
+    return islandShared->bestK.load(std::memory_order_acquire) <= k;
+}
+
+/**
+ * Body of an island process. The graph is copied after pinning so that it
+ * lives in memory local to the node.
+ */
+void runIsland(Instance* instance, ColoringAlgorithm algorithm,
+        unsigned long long seed)
+{
+    pinToNode(islandId);
+    srand((unsigned int) seed);
+    tsRandom.seed(seed);
+
+    std::vector<int> vertices(instance->nvertices);
+    for (int u = 0; u < instance->nvertices; ++u) vertices[u] = u;
+    Instance localInstance(*instance, vertices);
+    Solution localSolution(&localInstance);
+
+    Timing timing;
+    timing_setCurrent(&timing);
+    timing.start = timing_now();
+    algorithm(&localInstance, &localSolution);
+    if (localSolution.numViolations() == 0) island_exchange(localSolution);
+
+    IslandStats& stats = islandShared->stats()[islandId];
+    stats.k = localSolution.k();
+    stats.construction = timing.construction;
+    stats.iterations = timing.iterations;
+    stats.numRounds = std::min((int) timing.roundK.size(),
+            IslandShared::maxRounds(instance->nvertices));
+    IslandRound* rounds = islandShared->rounds(islandId);
+    for (int i = 0; i < stats.numRounds; ++i)
+    {
+        rounds[i].k = timing.roundK[i];
+        rounds[i].time = timing.roundTime[i];
+        rounds[i].counts = timing.roundCounts[i];
+    }
+}
+
+/**
+ * Colors the instance with numIslands processes running the algorithm,
+ * which exchange colorings every migrationInterval iterations. Falls back to
+ * a single run in this process if the segment cannot be mapped or no island
+ * finds a feasible coloring. The work of all islands is added to the timing
+ * of the calling thread, with the rounds of each island in turn.
+ */
+void island_constructSolution(Instance* instance, Solution* solution,
+        ColoringAlgorithm algorithm, int numIslands, int migrationInterval)
+{
+    int n = instance->nvertices;
+    size_t size = IslandShared::size(n, numIslands);
+    void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        perror("Could not map the island segment");
+        algorithm(instance, solution);
+        return;
+    }
+    IslandShared* shared = new (memory) IslandShared(n, numIslands);
+    std::fill(shared->stats(), shared->stats() + numIslands, IslandStats());
+
+    // Seeds are drawn here so that the run is reproducible with -s
+    std::vector<unsigned long long> seeds(numIslands);
+    for (int i = 0; i < numIslands; ++i) seeds[i] = tsRandom.next();
+
+    islandMigrationInterval = std::max(1, migrationInterval);
+    std::vector<pid_t> pids;
+    for (int i = 0; i < numIslands; ++i)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            islandShared = shared;
+            islandId = i;
+            runIsland(instance, algorithm, seeds[i]);
+            _exit(0);
+        }
+        if (pid == -1)
+        {
+            perror("Could not start island");
+            break;
+        }
+        pids.push_back(pid);
+    }
+    for (unsigned int i = 0; i < pids.size(); ++i) waitpid(pids[i], NULL, 0);
+
+    long long construction = 0;
+    long long iterations = 0;
+    for (int i = 0; i < numIslands; ++i)
+    {
+        const IslandStats& stats = shared->stats()[i];
+        construction += stats.construction;
+        iterations += stats.iterations;
+        std::cerr << "island " << i << ": k=" << stats.k
+                << " imports=" << stats.imports << std::endl;
+    }
+    Timing* timing = timing_current();
+    if (timing != NULL)
+    {
+        std::lock_guard<std::mutex> lock(timing->mutex);
+        timing->construction += construction;
+        timing->iterations += iterations;
+        for (int i = 0; i < numIslands; ++i)
+        {
+            const IslandRound* rounds = shared->rounds(i);
+            for (int r = 0; r < shared->stats()[i].numRounds; ++r)
+            {
+                timing->roundK.push_back(rounds[r].k);
+                timing->roundTime.push_back(rounds[r].time);
+                timing->roundCounts.push_back(rounds[r].counts);
+            }
+        }
+    }
+
+    if (shared->bestK.load() != INT_MAX)
+        std::copy(shared->coloring(), shared->coloring() + n, solution->coloring);
+    else
+        algorithm(instance, solution);
+
+    shared->~IslandShared();
+    munmap(memory, size);
+}
@@ -0,0 +1,22 @@
+#ifndef ISLAND_H_
+#define ISLAND_H_
+
+#include "coloring.h"
+
+/**
+ * Island model: several processes run the same algorithm on one instance,
+ * each pinned to a NUMA node and working on its own copy of the graph. The
+ * best coloring found so far and its number of colors are shared through a
+ * memory segment mapped before the processes are forked.
+ * Only the k descents of ts and sa migrate colorings, between rounds and
+ * while polling for a smaller k; the islands of any other algorithm run
+ * independently and the best of their colorings is kept.
+ */
+
+void island_constructSolution(Instance* instance, Solution* solution,
+        ColoringAlgorithm algorithm, int numIslands, int migrationInterval);
+
+bool island_exchange(Solution& solution);
+bool island_poll(long long iteration, int k);
+
+#endif /*ISLAND_H_*/
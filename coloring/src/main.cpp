@@ -1,69 +1,407 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
-#include <ctime>
+#include <cstdlib>
+#include <cstdio>
+#include <thread>
 
 #include "coloring.h"
 #include "dsatur.h"
 #include "rlf.h"
 #include "ts.h"
+#include "pgreedy.h"
+#include "ig.h"
+#include "sa.h"
+#include "multilevel.h"
+#include "autoselect.h"
+#include "sat.h"
+#include "driver.h"
+#include "trace.h"
+#include "inputstream.h"
+#include "checkpoint.h"
+#include "incremental.h"
+
+/**
+ * Returns the coloring algorithm with the given name, or NULL if there is no
+ * such algorithm.
+ */
+ColoringAlgorithm findAlgorithm(const std::string& algorithmName)
+{
+    if (algorithmName.compare("dsatur") == 0) return dsatur_constructSolution;
+    if (algorithmName.compare("rlf") == 0) return rlf_constructSolution;
+    if (algorithmName.compare("ts") == 0) return ts_constructSolution;
+    if (algorithmName.compare("pgreedy") == 0) return pgreedy_constructSolution;
+    if (algorithmName.compare("ig") == 0) return ig_constructSolution;
+    if (algorithmName.compare("sa") == 0) return sa_constructSolution;
+    if (algorithmName.compare("ml") == 0) return multilevel_constructSolution;
+    if (algorithmName.compare("sat") == 0) return sat_constructSolution;
+    if (algorithmName.compare("auto") == 0) return autoselect_constructSolution;
+    return NULL;
+}
+
+void printUsage(const char* programName)
+{
+    std::cerr << "Usage: " << programName << " [-r] [-c] [-x FRACTION] [-z] [-j THREADS] [-i ISLANDS [-m ITERATIONS]] [-n THREADS] [-s SEED] [-p] [-t TRACE_FILE] [-d ITERATIONS] [-g ALGORITHM_NAME] [-a T0,FACTOR,MOVES] [-l SECONDS] [-k CHECKPOINT_FILE [-e SECONDS]] [-f START_FILE] [-u UPDATE_FILE] ALGORITHM_NAME INSTANCE_FILE" << std::endl;
+    std::cerr << "       " << programName << " -b [-r] [-c] [-x FRACTION] [-z] [-j THREADS] [-s SEED] [-p] [-t TRACE_FILE] [-d ITERATIONS] [-g ALGORITHM_NAME] [-a T0,FACTOR,MOVES] [-l SECONDS] ALGORITHM_NAME[,ALGORITHM_NAME...] INSTANCE_FILE..." << std::endl;
+    std::cerr << "  -r  reduce the graph before coloring" << std::endl;
+    std::cerr << "  -c  color connected components independently" << std::endl;
+    std::cerr << "  -x  extract independent sets as color classes until the given fraction" << std::endl;
+    std::cerr << "      of the vertices is left, then color those (not with -r or -c)" << std::endl;
+    std::cerr << "  -z  keep the adjacency compressed (dsatur and rlf only, not with -r," << std::endl;
+    std::cerr << "      -c, -x or -i)" << std::endl;
+    std::cerr << "  -b  batch mode: run every algorithm over every instance" << std::endl;
+    std::cerr << "  -j  number of threads used with -c and by pgreedy, or of concurrent" << std::endl;
+    std::cerr << "      jobs with -b" << std::endl;
+    std::cerr << "      (default: all cores)" << std::endl;
+    std::cerr << "  -i  run the given number of processes, each pinned to a NUMA node," << std::endl;
+    std::cerr << "      that share their best coloring (not with -b, -r, -c, -x or -t)" << std::endl;
+    std::cerr << "  -m  iterations between checks of the colorings of other processes" << std::endl;
+    std::cerr << "      (default: 10000)" << std::endl;
+    std::cerr << "  -n  threads sharing the scan of the conflicting vertices in each ts" << std::endl;
+    std::cerr << "      iteration, worth it with thousands of them (default: 1)" << std::endl;
+    std::cerr << "  -s  seed of the random number generator" << std::endl;
+    std::cerr << "  -p  report hardware counters (Linux perf events) per phase" << std::endl;
+    std::cerr << "  -t  write a CSV trace of the best conflicts over time to the given file" << std::endl;
+    std::cerr << "      (runs are numbered in the order of the jobs)" << std::endl;
+    std::cerr << "  -d  dump tabu search counters to stderr every given number of" << std::endl;
+    std::cerr << "      iterations (needs a build with \"make COUNTERS=1\")" << std::endl;
+    std::cerr << "  -g  algorithm giving the initial solution of ts, sa and sat" << std::endl;
+    std::cerr << "      (default: dsatur)" << std::endl;
+    std::cerr << "  -a  cooling schedule of sa: initial temperature, factor applied to it" << std::endl;
+    std::cerr << "      and moves per vertex between decreases (default: 1,0.98,100)" << std::endl;
+    std::cerr << "  -l  time limit of sa and sat in seconds (default: none)" << std::endl;
+    std::cerr << "  -k  save the state of ts to the given file at intervals and on SIGTERM" << std::endl;
+    std::cerr << "  -e  seconds between checkpoints (default: 60)" << std::endl;
+    std::cerr << "  -f  start ts or sa from a checkpoint, continuing its round, or from a" << std::endl;
+    std::cerr << "      feasible coloring with one color per vertex" << std::endl;
+    std::cerr << "      (-k and -f not with -b, -r, -c, -x, -z or -i)" << std::endl;
+    std::cerr << "  -u  then apply the batches of changes in the given file to the graph," << std::endl;
+    std::cerr << "      recoloring incrementally, and write n, m and k after each batch" << std::endl;
+    std::cerr << "      (not with -b or -z)" << std::endl;
+    std::cerr << "Algorithm auto chooses one of the others from statistics of the graph" << std::endl;
+    std::cerr << "and writes them, with its choice, to stderr." << std::endl;
+    std::cerr << "Instance files ending in .gz or .zst are decompressed while parsed." << std::endl;
+}
 
 int main(int argc, char** argv) {
 
-	// Check if algorithm specification and input file were given
-	if (argc != 3)
+    // Read options
+    RunOptions options;
+    bool batch = false;
+    const char* traceFileName = NULL;
+    const char* checkpointFileName = NULL;
+    const char* startFileName = NULL;
+    const char* updateFileName = NULL;
+    double checkpointInterval = 60.0;
+    std::string initialAlgorithmName("dsatur");
+    int numThreads = std::max(1, (int) std::thread::hardware_concurrency());
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg)
+    {
+        std::string option(argv[arg]);
+        if (option.compare("-r") == 0)
+        {
+            options.reduce = true;
+        }
+        else if (option.compare("-c") == 0)
+        {
+            options.decompose = true;
+        }
+        else if (option.compare("-b") == 0)
+        {
+            batch = true;
+        }
+        else if (option.compare("-j") == 0 && arg + 1 < argc)
+        {
+            numThreads = std::max(1, atoi(argv[++arg]));
+        }
+        else if (option.compare("-n") == 0 && arg + 1 < argc)
+        {
+            ts_setScanThreads(atoi(argv[++arg]));
+        }
+        else if (option.compare("-s") == 0 && arg + 1 < argc)
+        {
+            int seed = atoi(argv[++arg]);
+            srand(seed);
+            tsRandom.seed(seed);
+        }
+        else if (option.compare("-z") == 0)
+        {
+            options.compress = true;
+        }
+        else if (option.compare("-x") == 0 && arg + 1 < argc)
+        {
+            options.residualFraction = atof(argv[++arg]);
+        }
+        else if (option.compare("-i") == 0 && arg + 1 < argc)
+        {
+            options.numIslands = std::max(1, atoi(argv[++arg]));
+        }
+        else if (option.compare("-m") == 0 && arg + 1 < argc)
+        {
+            options.migrationInterval = std::max(1, atoi(argv[++arg]));
+        }
+        else if (option.compare("-p") == 0)
+        {
+            if (!hwcounters_enable())
+                std::cerr << "Hardware counters are not available" << std::endl;
+        }
+        else if (option.compare("-t") == 0 && arg + 1 < argc)
+        {
+            traceFileName = argv[++arg];
+        }
+        else if (option.compare("-a") == 0 && arg + 1 < argc)
+        {
+            double temperature, factor;
+            int moves;
+            if (sscanf(argv[++arg], "%lf,%lf,%d", &temperature, &factor, &moves) != 3)
+            {
+                std::cerr << "Invalid schedule: " << argv[arg] << std::endl;
+                return 1;
+            }
+            sa_setSchedule(temperature, factor, moves);
+        }
+        else if (option.compare("-l") == 0 && arg + 1 < argc)
+        {
+            double seconds = atof(argv[++arg]);
+            sa_setTimeLimit(seconds);
+            sat_setTimeLimit(seconds);
+        }
+        else if (option.compare("-k") == 0 && arg + 1 < argc)
+        {
+            checkpointFileName = argv[++arg];
+        }
+        else if (option.compare("-e") == 0 && arg + 1 < argc)
+        {
+            checkpointInterval = atof(argv[++arg]);
+        }
+        else if (option.compare("-f") == 0 && arg + 1 < argc)
+        {
+            startFileName = argv[++arg];
+        }
+        else if (option.compare("-u") == 0 && arg + 1 < argc)
+        {
+            updateFileName = argv[++arg];
+        }
+        else if (option.compare("-g") == 0 && arg + 1 < argc)
+        {
+            initialAlgorithmName = argv[++arg];
+        }
+        else if (option.compare("-d") == 0 && arg + 1 < argc)
+        {
+            ts_setCounterDumpInterval(atoi(argv[++arg]));
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+    }
+
+	// Check if algorithm specification and input files were given
+	if ((!batch && argc - arg != 2) || (batch && argc - arg < 2))
 	{
-		std::cerr << "Usage: " << argv[0] << " ALGORITHM_NAME INSTANCE_FILE" << std::endl;
+		printUsage(argv[0]);
 		return 1;
 	}
-	std::string algorithmName(argv[1]);
-	std::string fileName(argv[2]);
+	std::string algorithmNames(argv[arg]);
 
-    std::ifstream in;
-    in.open(fileName.c_str(), std::ifstream::in);
+    // Look up all algorithms before running anything
+    ColoringAlgorithm initialAlgorithm = findAlgorithm(initialAlgorithmName);
+    if (initialAlgorithm == NULL || initialAlgorithm == ts_constructSolution
+            || initialAlgorithm == sa_constructSolution
+            || initialAlgorithm == sat_constructSolution
+            || initialAlgorithm == autoselect_constructSolution)
+    {
+        std::cerr << "Unknown initial algorithm: " << initialAlgorithmName << std::endl;
+        return 1;
+    }
+    ts_setInitialAlgorithm(initialAlgorithm);
     
-    Instance* instance = new Instance(in);
-    Solution* solution = new Solution(instance);
-
-    time_t start;
-    start = time(NULL);
+    std::vector<BatchJob> jobs;
+    std::stringstream names(algorithmNames);
+    std::string algorithmName;
+    while (std::getline(names, algorithmName, ','))
+    {
+        ColoringAlgorithm algorithm = findAlgorithm(algorithmName);
+        if (algorithm == NULL)
+        {
+            std::cerr << "Unknown algorithm: " << algorithmName << std::endl;
+            return 1;
+        }
+        for (int file = arg + 1; file < argc; ++file)
+        {
+            BatchJob job;
+            job.algorithmName = algorithmName;
+            job.algorithm = algorithm;
+            job.fileName = argv[file];
+            jobs.push_back(job);
+        }
+    }
 
-    if (algorithmName.compare("dsatur") == 0)
+    if (!batch && jobs.size() != 1)
     {
-	    dsatur_constructSolution(instance, solution);
+        printUsage(argv[0]);
+        return 1;
     }
-    else if (algorithmName.compare("rlf") == 0)
+    
+    // Islands are processes forked from a single thread, and the colorings
+    // they exchange must refer to the whole instance
+    if (options.numIslands > 1 && (batch || options.reduce
+            || options.decompose || options.residualFraction < 1.0
+            || traceFileName != NULL))
     {
-	    rlf_constructSolution(instance, solution);
+        printUsage(argv[0]);
+        return 1;
     }
-    else if (algorithmName.compare("ts") == 0)
+    if (options.residualFraction < 1.0 && (options.reduce || options.decompose))
     {
-	    ts_constructSolution(instance, solution);
+        printUsage(argv[0]);
+        return 1;
     }
     
-    time_t elapsedTime = time(NULL) - start;
+    // Only DSATUR and RLF read compressed adjacency lists
+    for (unsigned int i = 0; i < jobs.size() && options.compress; ++i)
+    {
+        if ((jobs[i].algorithm != dsatur_constructSolution
+                && jobs[i].algorithm != rlf_constructSolution)
+                || options.reduce || options.decompose
+                || options.residualFraction < 1.0 || options.numIslands > 1)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
     
-    int numViolations = solution->numViolations();
-    if (numViolations == 0)
+    // Checkpoints hold a single descent of ts on the whole instance
+    if ((checkpointFileName != NULL || startFileName != NULL)
+            && (batch || options.reduce || options.decompose
+            || options.residualFraction < 1.0 || options.compress
+            || options.numIslands > 1))
     {
-        std::cout << fileName.substr(0, fileName.size() - 4) << "\t"
-        		<< instance->nvertices << "\t"
-        		<< instance->nedges << "\t"
-        		<< solution->k() << "\t"
-        		<< elapsedTime << std::endl;
+        printUsage(argv[0]);
+        return 1;
     }
-    else
+    if (checkpointFileName != NULL && jobs[0].algorithm != ts_constructSolution)
     {
-        std::cout << fileName.substr(0, fileName.size() - 4)
-        		<< " Feasible solution not found. "
-                << "(" << numViolations << " violations)" << std::endl;
+        std::cerr << "Checkpoints are only taken by ts" << std::endl;
+        return 1;
     }
-    
+    if (startFileName != NULL && jobs[0].algorithm != ts_constructSolution
+            && jobs[0].algorithm != sa_constructSolution)
+    {
+        std::cerr << "Only ts and sa can start from a saved coloring" << std::endl;
+        return 1;
+    }
+    // Updates change the adjacency arrays in place
+    if (updateFileName != NULL && (batch || options.compress))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (traceFileName != NULL && !trace_open(traceFileName))
+    {
+        std::cerr << "Could not open trace file: " << traceFileName << std::endl;
+        return 1;
+    }
+
+    if (batch)
+    {
+        // Jobs already run concurrently, so components are colored serially
+        options.numThreads = 1;
+        pgreedy_setNumThreads(1);
+        autoselect_setNumThreads(1);
+        driver_runBatch(jobs, options, numThreads, std::cout);
+        trace_close();
+        return 0;
+    }
+    options.numThreads = numThreads;
+    pgreedy_setNumThreads(numThreads);
+    autoselect_setNumThreads(numThreads);
+	std::string fileName(jobs[0].fileName);
+
+    InputStream in;
+    in.open(fileName);
+    if (!in.is_open())
+    {
+        std::cerr << "Could not open instance file: " << fileName << std::endl;
+        trace_close();
+        return 1;
+    }
+
+    Timing timing;
+    timing_setCurrent(&timing);
+
+    PhaseStart parse;
+    timing_beginPhase(parse);
+    Instance* instance = new Instance(in, options.compress);
+    Solution* solution = new Solution(instance);
+    timing_endParse(parse);
+    if (in.bad())
+    {
+        std::cerr << "Invalid or corrupt instance file: " << fileName << std::endl;
+        trace_close();
+        return 1;
+    }
+
+    TsCheckpoint start;
+    if (startFileName != NULL)
+    {
+        Solution startSolution(instance);
+        bool loaded = checkpoint_load(startFileName, instance, start);
+        if (loaded)
+        {
+            std::copy(start.feasibleColoring.begin(), start.feasibleColoring.end(),
+                    startSolution.coloring);
+        }
+        if (!loaded || startSolution.numViolations() != 0)
+        {
+            std::cerr << "No feasible coloring of the instance in: " << startFileName << std::endl;
+            trace_close();
+            return 1;
+        }
+        ts_setStart(&start);
+    }
+    if (checkpointFileName != NULL)
+        ts_setCheckpoint(checkpointFileName, checkpointInterval);
+
+    timing.start = timing_now();
+    driver_runAlgorithm(instance, solution, jobs[0].algorithm, options);
+    timing.total = timing_now() - timing.start;
+
+    trace_close();
+    driver_printResult(std::cout, fileName, instance, solution, timing);
+
     in.close();
-	
+
+    if (updateFileName != NULL)
+    {
+        std::ifstream updateFile(updateFileName);
+        std::vector<GraphUpdate> updates;
+        if (!updateFile.is_open()
+                || !incremental_readUpdates(updateFile, instance->nvertices, updates))
+        {
+            std::cerr << "Could not read updates: " << updateFileName << std::endl;
+            return 1;
+        }
+        IncrementalState state(instance, solution);
+        for (unsigned int i = 0; i < updates.size(); ++i)
+        {
+            incremental_updateSolution(instance, solution, updates[i], state);
+            if (solution->numViolations() != 0)
+            {
+                std::cerr << "Illegal coloring after update " << (i + 1) << std::endl;
+                return 1;
+            }
+            std::cout << "update " << (i + 1) << "\t" << instance->nvertices
+                    << "\t" << instance->nedges << "\t" << state.k << std::endl;
+        }
+    }
+
     delete solution;
     delete instance;
-    
+
 	return 0;
 }
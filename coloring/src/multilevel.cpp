@@ -0,0 +1,210 @@
+#include "multilevel.h"
+#include "ts.h"
+#include "dsatur.h"
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+// Coarsening stops at this many vertices, or when a level merges fewer than
+// MIN_MERGED_FRACTION of its vertices
+#define COARSEST_SIZE 1000
+#define MIN_MERGED_FRACTION 0.1
+
+// Two-hop edges looked at when searching a partner for a vertex
+#define MAX_SCANNED_EDGES 1024
+
+// Iterations of each tabu search round when refining a level
+#define MIN_REFINE_ITERATIONS 100000
+#define REFINE_ITERATIONS_PER_VERTEX 2
+
+/**
+ * Graph in compressed sparse rows: the neighbors of vertex u are
+ * targets[offsets[u]] to targets[offsets[u + 1] - 1].
+ */
+struct CsrGraph
+{
+    int numVertices;
+    std::vector<int> offsets;
+    std::vector<int> targets;
+};
+
+void toCsr(Instance* instance, CsrGraph& graph)
+{
+    graph.numVertices = instance->nvertices;
+    graph.offsets.resize(graph.numVertices + 1);
+    graph.offsets[0] = 0;
+    for (int u = 0; u < graph.numVertices; ++u)
+        graph.offsets[u + 1] = graph.offsets[u] + instance->gamma[u][0];
+    graph.targets.resize(graph.offsets[graph.numVertices]);
+    for (int u = 0; u < graph.numVertices; ++u)
+    {
+        int* adj = instance->gamma[u];
+        std::copy(adj + 1, adj + 1 + adj[0], graph.targets.begin() + graph.offsets[u]);
+    }
+}
+
+/**
+ * Pairs each vertex, in random order, with the non-adjacent unpaired vertex
+ * that shares most neighbors with it, found among its two-hop neighbors.
+ * Paired vertices will have the same color, so merging vertices with similar
+ * neighborhoods adds few edges to the coarse graph. coarseOf receives the
+ * coarse vertex of each vertex; returns the number of coarse vertices.
+ */
+int matchVertices(const CsrGraph& graph, std::vector<int>& coarseOf)
+{
+    int n = graph.numVertices;
+    std::vector<int> order(n);
+    for (int u = 0; u < n; ++u) order[u] = u;
+    std::shuffle(order.begin(), order.end(), tsRandom);
+
+    std::vector<int> partner(n, -1);
+    std::vector<int> adjacentMark(n, -1);
+    std::vector<int> commonMark(n, -1);
+    std::vector<int> common(n, 0);
+    for (int i = 0; i < n; ++i)
+    {
+        int u = order[i];
+        if (partner[u] != -1) continue;
+
+        adjacentMark[u] = u;
+        for (int e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e)
+            adjacentMark[graph.targets[e]] = u;
+
+        int best = -1;
+        int scanned = 0;
+        for (int e = graph.offsets[u]; e < graph.offsets[u + 1] && scanned < MAX_SCANNED_EDGES; ++e)
+        {
+            int w = graph.targets[e];
+            for (int f = graph.offsets[w]; f < graph.offsets[w + 1] && scanned < MAX_SCANNED_EDGES; ++f, ++scanned)
+            {
+                int v = graph.targets[f];
+                if (adjacentMark[v] == u || partner[v] != -1) continue;
+                if (commonMark[v] != u)
+                {
+                    commonMark[v] = u;
+                    common[v] = 0;
+                }
+                common[v]++;
+                if (best == -1 || common[v] > common[best]) best = v;
+            }
+        }
+
+        if (best != -1)
+        {
+            partner[u] = best;
+            partner[best] = u;
+        }
+    }
+
+    int numCoarse = 0;
+    coarseOf.assign(n, -1);
+    for (int u = 0; u < n; ++u)
+    {
+        if (coarseOf[u] != -1) continue;
+        coarseOf[u] = numCoarse;
+        if (partner[u] != -1) coarseOf[partner[u]] = numCoarse;
+        numCoarse++;
+    }
+    return numCoarse;
+}
+
+/**
+ * Builds the coarse graph, in which coarse vertices are adjacent if any of
+ * their members are.
+ */
+void contract(const CsrGraph& graph, const std::vector<int>& coarseOf,
+        int numCoarse, CsrGraph& coarse)
+{
+    int n = graph.numVertices;
+
+    // Members of each coarse vertex, grouped by coarse vertex
+    std::vector<int> memberStart(numCoarse + 1, 0);
+    for (int u = 0; u < n; ++u) memberStart[coarseOf[u] + 1]++;
+    for (int c = 0; c < numCoarse; ++c) memberStart[c + 1] += memberStart[c];
+    std::vector<int> members(n);
+    std::vector<int> next(memberStart.begin(), memberStart.end() - 1);
+    for (int u = 0; u < n; ++u) members[next[coarseOf[u]]++] = u;
+
+    coarse.numVertices = numCoarse;
+    coarse.offsets.assign(numCoarse + 1, 0);
+    coarse.targets.clear();
+    std::vector<int> mark(numCoarse, -1);
+    for (int c = 0; c < numCoarse; ++c)
+    {
+        for (int m = memberStart[c]; m < memberStart[c + 1]; ++m)
+        {
+            int u = members[m];
+            for (int e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e)
+            {
+                int d = coarseOf[graph.targets[e]];
+                if (mark[d] == c) continue;
+                mark[d] = c;
+                coarse.targets.push_back(d);
+            }
+        }
+        coarse.offsets[c + 1] = coarse.targets.size();
+    }
+}
+
+/**
+ * Multilevel coloring: coarsens the graph by merging pairs of non-adjacent
+ * vertices, colors the coarsest graph with DSATUR, then projects the
+ * coloring back one level at a time. Every level is refined with bounded
+ * tabu search.
+ * A coloring of a coarse graph is a coloring of the finer one with the same
+ * number of colors, so refinement only has to lower k.
+ */
+void multilevel_constructSolution(Instance* instance, Solution* solution)
+{
+    std::vector<CsrGraph> graphs(1);
+    std::vector<std::vector<int> > coarseOf;
+    toCsr(instance, graphs[0]);
+
+    while (graphs.back().numVertices > COARSEST_SIZE)
+    {
+        std::vector<int> mapping;
+        int numCoarse = matchVertices(graphs.back(), mapping);
+        if (graphs.back().numVertices - numCoarse
+                < MIN_MERGED_FRACTION * graphs.back().numVertices) break;
+
+        graphs.push_back(CsrGraph());
+        contract(graphs[graphs.size() - 2], mapping, numCoarse, graphs.back());
+        coarseOf.push_back(std::vector<int>());
+        coarseOf.back().swap(mapping);
+    }
+
+    // Level 0 is the instance itself; levels are dropped once projected, so
+    // the coarsest one is remembered
+    int coarsest = graphs.size() - 1;
+    std::vector<int> coloring;
+    for (int level = coarsest; level >= 0; --level)
+    {
+        const CsrGraph& graph = graphs[level];
+        Instance* levelInstance = (level == 0) ? instance
+                : new Instance(graph.numVertices, graph.offsets, graph.targets);
+        Solution levelSolution(levelInstance);
+
+        if (level == coarsest)
+        {
+            dsatur_constructSolution(levelInstance, &levelSolution);
+        }
+        else
+        {
+            const std::vector<int>& mapping = coarseOf[level];
+            for (int u = 0; u < graph.numVertices; ++u)
+                levelSolution.coloring[u] = coloring[mapping[u]];
+        }
+        long long maxIterations = std::max((long long) MIN_REFINE_ITERATIONS,
+                (long long) REFINE_ITERATIONS_PER_VERTEX * graph.numVertices);
+        ts_refineSolution(levelInstance, &levelSolution, maxIterations);
+        coloring.assign(levelSolution.coloring,
+                levelSolution.coloring + graph.numVertices);
+
+        // This level is no longer needed once projected
+        if (level > 0) delete levelInstance;
+        graphs.pop_back();
+        if (level < (int) coarseOf.size()) std::vector<int>().swap(coarseOf[level]);
+    }
+
+    std::copy(coloring.begin(), coloring.end(), solution->coloring);
+}
@@ -0,0 +1,8 @@
+#ifndef MULTILEVEL_H_
+#define MULTILEVEL_H_
+
+#include "coloring.h"
+
+void multilevel_constructSolution(Instance* instance, Solution* solution);
+
+#endif /*MULTILEVEL_H_*/
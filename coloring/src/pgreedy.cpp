@@ -0,0 +1,250 @@
+#include "pgreedy.h"
+#include "timing.h"
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+// Vertices taken at once from the shared worklist by each thread
+#define CHUNK_SIZE 1024
+
+int pgreedyNumThreads = std::max(1, (int) std::thread::hardware_concurrency());
+
+// Cap on the threads of the runs on the current thread (0 for none), for
+// runs that share the cores with others
+thread_local int pgreedyThreadLimit = 0;
+
+void pgreedy_setNumThreads(int numThreads)
+{
+    pgreedyNumThreads = std::max(1, numThreads);
+}
+
+void pgreedy_setThreadLimit(int numThreads)
+{
+    pgreedyThreadLimit = std::max(0, numThreads);
+}
+
+/**
+ * State shared by the threads of one phase. Colors are atomic because a
+ * vertex may be read while a neighbor in another chunk is being colored;
+ * relaxed accesses are enough since conflicts are detected afterwards.
+ */
+struct GreedyRound
+{
+    Instance* instance;
+    std::atomic<int>* colors;
+    const std::vector<int>* worklist;
+    std::atomic<unsigned int> next;
+};
+
+/**
+ * Gives each vertex of the worklist the smallest color not used by its
+ * neighbors, as currently seen by this thread.
+ */
+void colorVertices(GreedyRound* round)
+{
+    const std::vector<int>& worklist = *round->worklist;
+
+    // forbidden[c] == u + 1 if color c is used by a neighbor of vertex u
+    std::vector<int> forbidden;
+    for (unsigned int begin = round->next.fetch_add(CHUNK_SIZE);
+            begin < worklist.size(); begin = round->next.fetch_add(CHUNK_SIZE))
+    {
+        unsigned int end = std::min(begin + CHUNK_SIZE, (unsigned int) worklist.size());
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            int u = worklist[i];
+            int* adj = round->instance->gamma[u];
+            if ((int) forbidden.size() < adj[0] + 1) forbidden.resize(adj[0] + 1, 0);
+
+            // Colors above the degree cannot all be forbidden
+            for (int *it = (adj + 1), *last = (it + adj[0]); it != last; ++it)
+            {
+                int color = round->colors[*it].load(std::memory_order_relaxed);
+                if (color != -1 && color <= adj[0]) forbidden[color] = u + 1;
+            }
+            int color = 0;
+            while (forbidden[color] == u + 1) ++color;
+            round->colors[u].store(color, std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * Collects into conflicting the vertices of the worklist that ended with the
+ * color of a neighbor with a smaller index. The neighbor keeps its color.
+ */
+void detectConflicts(GreedyRound* round, std::vector<int>* conflicting)
+{
+    const std::vector<int>& worklist = *round->worklist;
+    for (unsigned int begin = round->next.fetch_add(CHUNK_SIZE);
+            begin < worklist.size(); begin = round->next.fetch_add(CHUNK_SIZE))
+    {
+        unsigned int end = std::min(begin + CHUNK_SIZE, (unsigned int) worklist.size());
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            int u = worklist[i];
+            int color = round->colors[u].load(std::memory_order_relaxed);
+            int* adj = round->instance->gamma[u];
+            for (int *it = (adj + 1), *last = (it + adj[0]); it != last; ++it)
+            {
+                if (*it < u && round->colors[*it].load(std::memory_order_relaxed) == color)
+                {
+                    conflicting->push_back(u);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+enum GreedyPhase { COLOR_PHASE, DETECT_PHASE, STOP_PHASE };
+
+/**
+ * Threads started once per coloring that run every phase of every round
+ * together with the calling thread, as member 0. Members sleep between
+ * phases until the generation changes.
+ */
+struct GreedyTeam
+{
+    GreedyRound& round;
+    std::vector<std::vector<int> > found;
+    GreedyPhase phase;
+    long long generation;
+    int running;
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    std::vector<std::thread> threads;
+
+    GreedyTeam(GreedyRound& round, int numThreads) :
+        round(round), found(numThreads), phase(COLOR_PHASE), generation(0),
+        running(0)
+    {
+        for (int i = 1; i < numThreads; ++i)
+            threads.push_back(std::thread(&GreedyTeam::work, this, i));
+    }
+
+    ~GreedyTeam()
+    {
+        start(STOP_PHASE);
+        for (unsigned int i = 0; i < threads.size(); ++i) threads[i].join();
+    }
+
+    void start(GreedyPhase newPhase)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            phase = newPhase;
+            running = threads.size();
+            ++generation;
+        }
+        started.notify_all();
+    }
+
+    void runPhase(GreedyPhase phase, int member)
+    {
+        if (phase == COLOR_PHASE) colorVertices(&round);
+        else detectConflicts(&round, &found[member]);
+    }
+
+    void work(int member)
+    {
+        long long seen = 0;
+        while (true)
+        {
+            GreedyPhase current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (generation == seen) started.wait(lock);
+                seen = generation;
+                current = phase;
+            }
+            if (current == STOP_PHASE) return;
+            runPhase(current, member);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--running == 0) finished.notify_one();
+            }
+        }
+    }
+
+    /**
+     * Runs one phase over the worklist on all members, returning when all
+     * of them are done.
+     */
+    void run(GreedyPhase phase)
+    {
+        round.next = 0;
+        start(phase);
+        runPhase(phase, 0);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running > 0) finished.wait(lock);
+    }
+
+    void color()
+    {
+        run(COLOR_PHASE);
+    }
+
+    void detect(std::vector<int>& conflicting)
+    {
+        for (unsigned int i = 0; i < found.size(); ++i) found[i].clear();
+        run(DETECT_PHASE);
+        conflicting.clear();
+        for (unsigned int i = 0; i < found.size(); ++i)
+            conflicting.insert(conflicting.end(), found[i].begin(), found[i].end());
+    }
+};
+
+/**
+ * Speculative parallel greedy coloring: all uncolored vertices are colored
+ * at once, in largest-degree-first order, and those that ended up in conflict
+ * are colored again in the next round, until there is no conflict. Quality
+ * is below DSATUR, but each round is a parallel pass over the edges.
+ */
+void pgreedy_constructSolution(Instance* instance, Solution* solution)
+{
+    PhaseStart phase;
+    timing_beginPhase(phase);
+
+    int n = instance->nvertices;
+
+    // Sort vertices by decreasing degree with a counting sort
+    int maxDegree = 0;
+    for (int u = 0; u < n; ++u) maxDegree = std::max(maxDegree, instance->gamma[u][0]);
+    std::vector<int> start(maxDegree + 2, 0);
+    for (int u = 0; u < n; ++u) start[maxDegree - instance->gamma[u][0] + 1]++;
+    for (int d = 1; d <= maxDegree + 1; ++d) start[d] += start[d - 1];
+    std::vector<int> worklist(n);
+    for (int u = 0; u < n; ++u) worklist[start[maxDegree - instance->gamma[u][0]]++] = u;
+
+    std::atomic<int>* colors = new std::atomic<int>[n];
+    for (int u = 0; u < n; ++u) colors[u].store(-1, std::memory_order_relaxed);
+
+    GreedyRound round;
+    round.instance = instance;
+    round.colors = colors;
+    round.worklist = &worklist;
+
+    int numThreads = pgreedyNumThreads;
+    if (pgreedyThreadLimit > 0) numThreads = std::min(numThreads, pgreedyThreadLimit);
+    numThreads = std::max(1, std::min(numThreads, n / CHUNK_SIZE + 1));
+    std::vector<int> conflicting;
+    {
+        GreedyTeam team(round, numThreads);
+        while (!worklist.empty())
+        {
+            team.color();
+            team.detect(conflicting);
+            worklist.swap(conflicting);
+        }
+    }
+
+    for (int u = 0; u < n; ++u) solution->coloring[u] = colors[u].load();
+    delete[] colors;
+
+    timing_addConstruction(phase);
+}
@@ -0,0 +1,13 @@
+#ifndef PGREEDY_H_
+#define PGREEDY_H_
+
+#include "coloring.h"
+
+void pgreedy_constructSolution(Instance* instance, Solution* solution);
+
+void pgreedy_setNumThreads(int numThreads);
+
+// Caps the threads of the runs on the calling thread, 0 for no cap
+void pgreedy_setThreadLimit(int numThreads);
+
+#endif /*PGREEDY_H_*/
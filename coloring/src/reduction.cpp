@@ -0,0 +1,277 @@
+#include "reduction.h"
+#include <vector>
+#include <algorithm>
+
+/**
+ * Comparison used to sort vertices by decreasing degree.
+ */
+struct DegreeGreater
+{
+    Instance* instance;
+
+    DegreeGreater(Instance* instance) : instance(instance) {}
+
+    bool operator()(int u, int v) const
+    {
+        return instance->gamma[u][0] > instance->gamma[v][0];
+    }
+};
+
+/**
+ * Finds a clique greedily, starting from each of a few vertices of highest
+ * degree and repeatedly adding the candidate of highest degree. The size of
+ * the clique is a lower bound for the number of colors.
+ */
+void reduction_greedyClique(Instance* instance, std::vector<int>& clique)
+{
+    int numVertices = instance->nvertices;
+    clique.clear();
+    if (numVertices == 0) return;
+
+    std::vector<int> order(numVertices);
+    for (int i = 0; i < numVertices; ++i) order[i] = i;
+    int numStarts = std::min(numVertices, 16);
+    std::partial_sort(order.begin(), order.begin() + numStarts, order.end(),
+            DegreeGreater(instance));
+
+    std::vector<int> mark(numVertices, 0);
+    int stamp = 0;
+    std::vector<int> current, candidates, nextCandidates;
+    for (int i = 0; i < numStarts; ++i)
+    {
+        int start = order[i];
+        current.assign(1, start);
+        int* adj = instance->gamma[start];
+        candidates.assign(adj + 1, adj + 1 + adj[0]);
+
+        while (!candidates.empty())
+        {
+            // Choose the candidate of highest degree
+            int v = candidates[0];
+            for (unsigned int j = 1; j < candidates.size(); ++j)
+            {
+                if (instance->gamma[candidates[j]][0] > instance->gamma[v][0])
+                    v = candidates[j];
+            }
+            current.push_back(v);
+
+            // Keep only candidates adjacent to the chosen vertex
+            ++stamp;
+            adj = instance->gamma[v];
+            for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+            {
+                mark[*it] = stamp;
+            }
+            nextCandidates.clear();
+            for (unsigned int j = 0; j < candidates.size(); ++j)
+            {
+                if (mark[candidates[j]] == stamp)
+                    nextCandidates.push_back(candidates[j]);
+            }
+            candidates.swap(nextCandidates);
+        }
+
+        if (current.size() > clique.size()) clique = current;
+    }
+}
+
+/**
+ * Appends vertex to the removal order and updates the residual degree of
+ * the vertices that remain in the graph.
+ */
+void removeVertex(Instance* instance, int vertexId, std::vector<int>& degree,
+        std::vector<char>& removed, std::vector<int>& removalOrder)
+{
+    removed[vertexId] = 1;
+    removalOrder.push_back(vertexId);
+
+    // Gets adjacency of vertex vertexId
+    int* adj = instance->gamma[vertexId];
+
+    // Iteration starts on index 1 and ends adj[0] indices after the start
+    for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+    {
+        if (!removed[*it]) --degree[*it];
+    }
+}
+
+/**
+ * Iteratively removes vertices whose residual degree is below the lower
+ * bound. Any coloring of the remaining graph with at least lowerBound colors
+ * has a free color for each of them.
+ */
+void peelLowDegreeVertices(Instance* instance, int lowerBound,
+        std::vector<int>& degree, std::vector<char>& removed,
+        std::vector<int>& removalOrder)
+{
+    std::vector<int> stack;
+    for (int u = 0; u < instance->nvertices; ++u)
+    {
+        if (!removed[u] && degree[u] < lowerBound) stack.push_back(u);
+    }
+
+    while (!stack.empty())
+    {
+        int u = stack.back();
+        stack.pop_back();
+        if (removed[u]) continue;
+        removeVertex(instance, u, degree, removed, removalOrder);
+
+        // Neighbors whose degree dropped below the bound are peeled as well
+        int* adj = instance->gamma[u];
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            int v = *it;
+            if (!removed[v] && degree[v] < lowerBound) stack.push_back(v);
+        }
+    }
+}
+
+/**
+ * Removes vertices u whose residual neighborhood is contained in the residual
+ * neighborhood of another vertex v. Vertex u can always take the color of v.
+ * The sweep gives up after scanning a constant multiple of the edges, so
+ * that dense graphs are not slowed down by a reduction that rarely applies.
+ * Returns whether any vertex was removed.
+ */
+bool removeDominatedVertices(Instance* instance, std::vector<int>& degree,
+        std::vector<char>& removed, std::vector<int>& removalOrder)
+{
+    int numVertices = instance->nvertices;
+    long long budget = 16 * (2 * (long long) instance->nedges + numVertices);
+
+    // neighborOf[x] == u marks x as a residual neighbor of u, and
+    // seen[x] == stamp avoids counting repeated edges twice
+    std::vector<int> neighborOf(numVertices, -1);
+    std::vector<int> seen(numVertices, -1);
+    int stamp = 0;
+    bool found = false;
+
+    for (int u = 0; u < numVertices && budget > 0; ++u)
+    {
+        if (removed[u]) continue;
+
+        // Mark the residual neighbors of u and pick the one of lowest degree,
+        // since every dominating vertex must be adjacent to it
+        int w = -1;
+        int numNeighbors = 0;
+        int* adj = instance->gamma[u];
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            int x = *it;
+            if (removed[x] || neighborOf[x] == u) continue;
+            neighborOf[x] = u;
+            ++numNeighbors;
+            if (w == -1 || degree[x] < degree[w]) w = x;
+        }
+        if (w == -1) continue;
+
+        int* wAdj = instance->gamma[w];
+        for (int *it = (wAdj + 1), *end = (it + wAdj[0]); it != end; ++it)
+        {
+            int v = *it;
+            if (v == u || removed[v] || degree[v] < numNeighbors) continue;
+
+            // Count the residual neighbors of u that are also adjacent to v
+            ++stamp;
+            int common = 0;
+            int* vAdj = instance->gamma[v];
+            for (int *it2 = (vAdj + 1), *end2 = (it2 + vAdj[0]); it2 != end2; ++it2)
+            {
+                int x = *it2;
+                if (neighborOf[x] == u && seen[x] != stamp && !removed[x])
+                {
+                    seen[x] = stamp;
+                    ++common;
+                }
+            }
+            budget -= vAdj[0];
+
+            if (common == numNeighbors)
+            {
+                removeVertex(instance, u, degree, removed, removalOrder);
+                found = true;
+                break;
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+ * Colors removed vertices greedily with the smallest color unused by their
+ * neighbors, in reverse order of removal.
+ */
+void reinsertVertices(Instance* instance, Solution* solution,
+        const std::vector<int>& removalOrder)
+{
+    std::vector<int> usedBy(instance->nvertices + 1, -1);
+    for (int i = removalOrder.size() - 1; i >= 0; --i)
+    {
+        int u = removalOrder[i];
+
+        // Gets adjacency of vertex u
+        int* adj = instance->gamma[u];
+
+        // Iteration starts on index 1 and ends adj[0] indices after the start
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            int color = solution->coloring[*it];
+            if (color != -1) usedBy[color] = u;
+        }
+
+        int color = 0;
+        while (usedBy[color] == u) ++color;
+        solution->coloring[u] = color;
+    }
+}
+
+/**
+ * Shrinks the instance by peeling vertices of degree below a clique lower
+ * bound and removing dominated vertices, colors the remaining core with the
+ * given algorithm, and then colors the removed vertices greedily.
+ */
+void reduction_constructSolution(Instance* instance, Solution* solution,
+        ColoringAlgorithm algorithm)
+{
+    int numVertices = instance->nvertices;
+
+    std::vector<int> clique;
+    reduction_greedyClique(instance, clique);
+    int lowerBound = clique.size();
+
+    // Residual degree of each vertex that was not removed yet
+    std::vector<int> degree(numVertices);
+    for (int i = 0; i < numVertices; ++i) degree[i] = instance->gamma[i][0];
+    std::vector<char> removed(numVertices, 0);
+    std::vector<int> removalOrder;
+
+    bool reduced = true;
+    while (reduced)
+    {
+        peelLowDegreeVertices(instance, lowerBound, degree, removed,
+                removalOrder);
+        reduced = removeDominatedVertices(instance, degree, removed,
+                removalOrder);
+    }
+
+    // Color the core, i.e., the subgraph induced by the remaining vertices
+    std::vector<int> coreVertices;
+    for (int u = 0; u < numVertices; ++u)
+    {
+        if (!removed[u]) coreVertices.push_back(u);
+    }
+    if (!coreVertices.empty())
+    {
+        Instance core(*instance, coreVertices);
+        Solution coreSolution(&core);
+        algorithm(&core, &coreSolution);
+        for (int i = 0; i < core.nvertices; ++i)
+        {
+            solution->coloring[coreVertices[i]] = coreSolution.coloring[i];
+        }
+    }
+
+    reinsertVertices(instance, solution, removalOrder);
+}
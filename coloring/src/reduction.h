@@ -0,0 +1,11 @@
+#ifndef REDUCTION_H_
+#define REDUCTION_H_
+
+#include "coloring.h"
+
+void reduction_greedyClique(Instance* instance, std::vector<int>& clique);
+
+void reduction_constructSolution(Instance* instance, Solution* solution,
+        ColoringAlgorithm algorithm);
+
+#endif /*REDUCTION_H_*/
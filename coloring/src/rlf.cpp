@@ -1,5 +1,7 @@
 #include "rlf.h"
+#include "timing.h"
 #include <set>
+#include <vector>
 
 /**
  * Returns the vertex with most links to the frontier, i.e., to vertices that
@@ -42,7 +44,8 @@ int mostLinkedToFrontier(std::set<int>& uncoloredUnlinked,
 /**
  * Move vertex to the frontier and update its adjacencies accordingly.
  */
-void moveVertexToFrontier(Instance* instance, int vertexId, std::set<int>& uncoloredUnlinked, int* numLinksToFrontier)
+void moveVertexToFrontier(Instance* instance, int vertexId, std::set<int>& uncoloredUnlinked, int* numLinksToFrontier,
+		std::vector<int>& buffer)
 {
 	// Remove from unlinked, since all vertices on the frontier are supposed
 	// to be linked to a colored vertex
@@ -53,12 +56,11 @@ void moveVertexToFrontier(Instance* instance, int vertexId, std::set<int>& uncol
 	// Since this is a new vertex on the frontier, the count of links to
 	// frontier for each uncolored adjacent vertex is incremented
 	
-    // Gets adjacency of vertex vertexId
-    int* adj = instance->gamma[vertexId];
+    // Gets adjacency of vertex vertexId, which may be compressed
+    const int* adj = instance->neighbors(vertexId, buffer);
     int adjVertexId;
     
-    // Iteration starts on index 1 and ends adj[0] indices after the start
-	for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+	for (const int *it = adj, *end = (it + instance->degree(vertexId)); it != end; ++it)
 	{
 		adjVertexId = *it;
 		++numLinksToFrontier[adjVertexId];
@@ -70,7 +72,8 @@ void moveVertexToFrontier(Instance* instance, int vertexId, std::set<int>& uncol
  */
 void updateAfterColoring(Instance* instance, Solution* solution, int vertexId,
 		std::set<int>& uncolored, std::set<int>& uncoloredUnlinked,
-		int* numLinksToFrontier, int* numLinksToUncolored)
+		int* numLinksToFrontier, int* numLinksToUncolored,
+		std::vector<int>& buffer, std::vector<int>& adjBuffer)
 {
 	// Since the vertex was colored, it is removed from both uncolored sets
 	uncolored.erase(vertexId);
@@ -78,12 +81,11 @@ void updateAfterColoring(Instance* instance, Solution* solution, int vertexId,
 
 	// Then, all remaining uncolored vertices adjacent to it enter the frontier
 	
-    // Get adjacency of vertex vertexId
-    int* adj = instance->gamma[vertexId];
+    // Get adjacency of vertex vertexId, which may be compressed
+    const int* adj = instance->neighbors(vertexId, buffer);
     int adjVertexId;
     
-    // Iteration starts on index 1 and ends adj[0] indices after the start
-	for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+	for (const int *it = adj, *end = (it + instance->degree(vertexId)); it != end; ++it)
 	{
 		adjVertexId = *it;
 		
@@ -95,12 +97,14 @@ void updateAfterColoring(Instance* instance, Solution* solution, int vertexId,
 		--numLinksToUncolored[adjVertexId];
 		
 		moveVertexToFrontier(instance, adjVertexId, uncoloredUnlinked,
-				numLinksToFrontier);
+				numLinksToFrontier, adjBuffer);
 	}
 }
 
 void rlf_constructSolution(Instance* instance, Solution* solution)
 {
+    PhaseStart phase;
+    timing_beginPhase(phase);
 	int numVertices = instance->nvertices;
 
 	// Initialize data structures
@@ -123,10 +127,12 @@ void rlf_constructSolution(Instance* instance, Solution* solution)
     int* numLinksToUncolored = new int[numVertices];
     for (int i = 0; i < numVertices; ++i)
     {
-    	// Index zero of gamma[i] contains its size
-    	numLinksToUncolored[i] = instance->gamma[i][0];
+    	numLinksToUncolored[i] = instance->degree(i);
     }
     
+    // Decoded adjacencies of the colored vertex and of its neighbors
+    std::vector<int> buffer, adjBuffer;
+    
     int currentColor = 0;
     while (uncolored.size() > 0)
 	{
@@ -145,7 +151,7 @@ void rlf_constructSolution(Instance* instance, Solution* solution)
 			solution->coloring[vertexId] = currentColor;
 			updateAfterColoring(instance, solution, vertexId, uncolored,
 					uncoloredUnlinked, numLinksToFrontier,
-					numLinksToUncolored);
+					numLinksToUncolored, buffer, adjBuffer);
 		}
 		
 		// When all uncolored vertices are linked to a vertex in the current
@@ -155,4 +161,6 @@ void rlf_constructSolution(Instance* instance, Solution* solution)
     
     if (numLinksToUncolored) delete[] numLinksToUncolored;
     if (numLinksToFrontier) delete[] numLinksToFrontier;
+
+    timing_addConstruction(phase);
 }
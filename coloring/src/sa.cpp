@@ -0,0 +1,119 @@
+#include "sa.h"
+#include "ts.h"
+#include "timing.h"
+#include "trace.h"
+#include "island.h"
+#include <cmath>
+#include <algorithm>
+
+// Temperature below which it stops decreasing
+#define FINAL_TEMPERATURE 0.01
+
+// Temperature steps without a new best before a round gives up
+#define MAX_STALLED_STEPS 100
+
+// Moves between looks at the clock
+#define CLOCK_INTERVAL 1024
+
+// Cooling schedule: the temperature starts at initialTemperature and is
+// multiplied by coolingFactor every movesPerVertex * n moves
+double initialTemperature = 1.0;
+double coolingFactor = 0.98;
+int movesPerVertex = 100;
+
+// Time budget of the whole descent in nanoseconds (0 for none), and the
+// deadline it gives for the run of the current thread
+long long timeLimit = 0;
+thread_local long long deadline = 0;
+
+void sa_setSchedule(double temperature, double factor, int moves)
+{
+    initialTemperature = temperature;
+    coolingFactor = factor;
+    movesPerVertex = std::max(1, moves);
+}
+
+void sa_setTimeLimit(double seconds)
+{
+    timeLimit = (long long) (seconds * 1e9);
+}
+
+/**
+ * Simulated annealing on k colors: a conflicting vertex gets a random other
+ * color, and the move is taken if it does not add conflicts, or otherwise
+ * with probability exp(-delta / temperature). The vertex is drawn uniformly
+ * among the conflicting ones. Deltas come from the counts of adjacent
+ * colors, so a move costs no neighborhood scan. Returns the number of moves
+ * tried.
+ */
+template <typename Count>
+long long annealingSearch(Solution& bestSolution,
+        CountTable<Count, 0>& countAdjColors,
+        ConflictList& conflictingVertices, const int k)
+{
+    int n = bestSolution.instance->nvertices;
+    int bestValue = calculateValue(bestSolution);
+    if (k < 2) return 0;
+    
+    Solution currentSolution = bestSolution;
+    int currentValue = bestValue;
+    
+    long long movesPerStep = (long long) movesPerVertex * n;
+    double temperature = initialTemperature;
+    int stalledSteps = 0;
+    long long it = 0;
+    
+    trace_event(0, k, bestValue);
+    
+    while (bestValue > 0 && stalledSteps < MAX_STALLED_STEPS)
+    {
+        bool improved = false;
+        for (long long move = 0; move < movesPerStep && currentValue > 0; ++move)
+        {
+            int u = conflictingVertices[tsRandom(conflictingVertices.size())];
+            int currentColor = currentSolution.coloring[u];
+            int newColor = tsRandom(k - 1);
+            if (newColor >= currentColor) ++newColor;
+            
+            int delta = (int) countAdjColors[u][newColor]
+                    - (int) countAdjColors[u][currentColor];
+            if (delta <= 0 || tsRandom.uniform() < exp(-delta / temperature))
+            {
+                applyMove(currentSolution, countAdjColors, conflictingVertices,
+                        std::make_pair(u, newColor));
+                currentValue += delta;
+            }
+            ++it;
+            
+            if (currentValue < bestValue)
+            {
+                bestSolution = currentSolution;
+                bestValue = currentValue;
+                improved = true;
+                trace_event(it, k, bestValue);
+            }
+            if (it % CLOCK_INTERVAL == 0 && deadline != 0 && timing_now() > deadline)
+                return it;
+            
+            // Give up if another island already has a coloring with k colors
+            if (island_poll(it, k)) return it;
+        }
+        
+        temperature = std::max(FINAL_TEMPERATURE, temperature * coolingFactor);
+        stalledSteps = improved ? 0 : stalledSteps + 1;
+    }
+    
+    return it;
+}
+
+/**
+ * Lowers k with simulated annealing, as ts_constructSolution does with tabu
+ * search, until a round fails or the time limit is reached.
+ */
+void sa_constructSolution(Instance* instance, Solution* solution)
+{
+    deadline = (timeLimit > 0) ? timing_now() + timeLimit : 0;
+    KColoringSearch search = { annealingSearch<unsigned char>,
+            annealingSearch<unsigned short>, annealingSearch<int> };
+    ts_descendK(instance, solution, search);
+}
@@ -0,0 +1,12 @@
+#ifndef SA_H_
+#define SA_H_
+
+#include "coloring.h"
+
+void sa_constructSolution(Instance* instance, Solution* solution);
+
+void sa_setSchedule(double initialTemperature, double coolingFactor,
+        int movesPerVertex);
+void sa_setTimeLimit(double seconds);
+
+#endif /*SA_H_*/
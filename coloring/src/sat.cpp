@@ -0,0 +1,211 @@
+#include "sat.h"
+#include "satsolver.h"
+#include "ts.h"
+#include "reduction.h"
+#include "timing.h"
+#include "trace.h"
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+// Time budget of the whole descent in nanoseconds (0 for none)
+long long satTimeLimit = 0;
+
+void sat_setTimeLimit(double seconds)
+{
+    satTimeLimit = (long long) (seconds * 1e9);
+}
+
+/**
+ * Variables of the k-coloring encoding for colors 0 to numColors - 1:
+ * x(u, c) tells that vertex u has color c, and used(c) that color c may be
+ * taken by some vertex.
+ */
+struct ColoringVariables
+{
+    int nvertices;
+    int numColors;
+
+    ColoringVariables(int nvertices, int numColors) :
+        nvertices(nvertices), numColors(numColors) {}
+
+    int x(int u, int c) const
+    {
+        return u * numColors + c;
+    }
+
+    int used(int c) const
+    {
+        return nvertices * numColors + c;
+    }
+
+    int count() const
+    {
+        return (nvertices + 1) * numColors;
+    }
+};
+
+/**
+ * Adds the clauses of a numColors-coloring: every vertex has a color,
+ * adjacent vertices do not share one, and a vertex only takes a color that
+ * is used. Colors are used in order, so assuming that color k is not used
+ * asks for a k-coloring. The vertices of the clique get the first colors,
+ * which removes the symmetric colorings that permute those.
+ */
+void encodeColoring(Instance* instance, const ColoringVariables& variables,
+        const std::vector<int>& clique, SatSolver& solver)
+{
+    while (solver.numVariables() < variables.count()) solver.newVariable();
+
+    int numColors = variables.numColors;
+    std::vector<int> clause;
+    for (int u = 0; u < instance->nvertices; ++u)
+    {
+        clause.clear();
+        for (int c = 0; c < numColors; ++c)
+            clause.push_back(satsolver_literal(variables.x(u, c), false));
+        solver.addClause(clause);
+
+        // Gets adjacency of vertex u
+        int* adj = instance->gamma[u];
+
+        // Iteration starts on index 1 and ends adj[0] indices after the start
+        for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
+        {
+            int v = *it;
+            if (v < u) continue;
+            for (int c = 0; c < numColors; ++c)
+            {
+                clause.clear();
+                clause.push_back(satsolver_literal(variables.x(u, c), true));
+                clause.push_back(satsolver_literal(variables.x(v, c), true));
+                solver.addClause(clause);
+            }
+        }
+
+        for (int c = 0; c < numColors; ++c)
+        {
+            clause.clear();
+            clause.push_back(satsolver_literal(variables.x(u, c), true));
+            clause.push_back(satsolver_literal(variables.used(c), false));
+            solver.addClause(clause);
+        }
+    }
+
+    for (int c = 1; c < numColors; ++c)
+    {
+        clause.clear();
+        clause.push_back(satsolver_literal(variables.used(c), true));
+        clause.push_back(satsolver_literal(variables.used(c - 1), false));
+        solver.addClause(clause);
+    }
+
+    for (unsigned int i = 0; i < clique.size(); ++i)
+    {
+        clause.assign(1, satsolver_literal(variables.x(clique[i], i), false));
+        solver.addClause(clause);
+    }
+}
+
+/**
+ * Makes the search start from a coloring: deciding first that a vertex has
+ * its color there, which rules that color out for the neighbors, rather
+ * than that it lacks some color, which implies little.
+ */
+void setPhases(const Solution& solution, const ColoringVariables& variables,
+        SatSolver& solver)
+{
+    for (int u = 0; u < variables.nvertices; ++u)
+    {
+        for (int c = 0; c < variables.numColors; ++c)
+            solver.setPhase(variables.x(u, c), solution.coloring[u] == c);
+    }
+}
+
+/**
+ * Reads the coloring of the model, each vertex taking its first color.
+ */
+void readColoring(const SatSolver& solver, const ColoringVariables& variables,
+        Solution& solution)
+{
+    for (int u = 0; u < variables.nvertices; ++u)
+    {
+        int c = 0;
+        while (!solver.modelValue(variables.x(u, c))) ++c;
+        solution.coloring[u] = c;
+    }
+}
+
+/**
+ * Lowers k from the coloring of the initial algorithm with an incremental
+ * SAT solver, down to the size of a clique found greedily. The formula is
+ * built once, for one color less than the initial coloring, and each k is
+ * asked for by assuming that color k is not used, so the clauses learned
+ * for a k are kept for the next ones. Stops when a k has no coloring, which
+ * proves the previous one optimal, or at the time limit; the outcome goes
+ * to stderr.
+ */
+void sat_constructSolution(Instance* instance, Solution* solution)
+{
+    long long deadline = (satTimeLimit > 0) ? timing_now() + satTimeLimit : 0;
+
+    Solution bestSolution(instance);
+    createFeasibleSolution(instance, bestSolution);
+    compactColors(bestSolution);
+    int k = bestSolution.k();
+
+    std::vector<int> clique;
+    reduction_greedyClique(instance, clique);
+    int lowerBound = clique.size();
+
+    SatSolver::Result result = SatSolver::SATISFIABLE;
+    if (k > lowerBound)
+    {
+        PhaseStart encoding;
+        timing_beginPhase(encoding);
+        ColoringVariables variables(instance->nvertices, k - 1);
+        SatSolver solver;
+        encodeColoring(instance, variables, clique, solver);
+        setPhases(bestSolution, variables, solver);
+        timing_addConstruction(encoding);
+
+        Solution satSolution(instance);
+        while (result == SatSolver::SATISFIABLE && k > lowerBound)
+        {
+            std::vector<int> assumptions;
+            if (k - 1 < variables.numColors)
+                assumptions.push_back(satsolver_literal(variables.used(k - 1), true));
+
+            PhaseStart round;
+            timing_beginPhase(round);
+            long long startConflicts = solver.numConflicts();
+            result = solver.solve(assumptions, deadline);
+            timing_addRound(k - 1, round, solver.numConflicts() - startConflicts);
+
+            if (result == SatSolver::SATISFIABLE)
+            {
+                readColoring(solver, variables, satSolution);
+                bestSolution = satSolution;
+                compactColors(bestSolution);
+                k = bestSolution.k();
+                trace_event(solver.numConflicts(), k, 0);
+            }
+        }
+    }
+
+    std::ostringstream outcome;
+    if (result == SatSolver::SATISFIABLE)
+        outcome << "sat: clique of " << lowerBound << " vertices, ";
+    else if (result == SatSolver::UNSATISFIABLE)
+        outcome << "sat: no coloring with " << (k - 1) << " colors, ";
+    else
+        outcome << "sat: time limit reached looking for " << (k - 1) << " colors, ";
+    outcome << k << " colors" << ((result == SatSolver::UNKNOWN) ? "" : " are optimal")
+            << std::endl;
+    std::cerr << outcome.str();
+
+    for (int u = 0; u < instance->nvertices; ++u)
+    {
+        solution->coloring[u] = bestSolution.coloring[u];
+    }
+}
@@ -0,0 +1,10 @@
+#ifndef SAT_H_
+#define SAT_H_
+
+#include "coloring.h"
+
+void sat_constructSolution(Instance* instance, Solution* solution);
+
+void sat_setTimeLimit(double seconds);
+
+#endif /*SAT_H_*/
@@ -0,0 +1,661 @@
+#include "satsolver.h"
+#include "timing.h"
+#include <algorithm>
+
+// Activity decays of variables and learned clauses per conflict
+#define VARIABLE_DECAY 0.95
+#define CLAUSE_DECAY 0.999
+
+// Conflicts per unit of the Luby restart sequence
+#define RESTART_BASE 100
+
+// Conflicts before the first removal of learned clauses, and growth of the
+// interval between removals
+#define FIRST_REDUCTION 2000
+#define REDUCTION_INCREMENT 300
+
+// Learned clauses of this LBD or lower are never removed
+#define KEEP_LBD 2
+
+// Conflicts, and decisions, between looks at the clock
+#define CLOCK_INTERVAL 256
+
+/**
+ * Element i of the Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, ...
+ */
+long long luby(int i)
+{
+    int size = 1, power = 0;
+    while (size < i + 1)
+    {
+        power++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != i)
+    {
+        size = (size - 1) >> 1;
+        power--;
+        i = i % size;
+    }
+    return 1LL << power;
+}
+
+SatSolver::SatSolver() :
+    ok(true), timedOut(false), nextReduction(FIRST_REDUCTION), numReductions(0),
+    propagated(0), variableIncrement(1.0), clauseIncrement(1.0f), stamp(0),
+    conflicts(0), decisions(0) {}
+
+int SatSolver::newVariable()
+{
+    int variable = numVariables();
+    values.push_back(0);
+    values.push_back(0);
+    watches.resize(values.size());
+    level.push_back(0);
+    reason.push_back(-1);
+    savedNegated.push_back(1);
+    seen.push_back(0);
+    activity.push_back(0.0);
+    heapPosition.push_back(-1);
+    heapInsert(variable);
+    return variable;
+}
+
+void SatSolver::setPhase(int variable, bool value)
+{
+    savedNegated[variable] = value ? 0 : 1;
+}
+
+int SatSolver::numVariables() const
+{
+    return (int) level.size();
+}
+
+long long SatSolver::numConflicts() const
+{
+    return conflicts;
+}
+
+bool SatSolver::modelValue(int variable) const
+{
+    return model[variable] != 0;
+}
+
+int SatSolver::decisionLevel() const
+{
+    return (int) trailLimits.size();
+}
+
+void SatSolver::assign(int literal, int reasonClause)
+{
+    int variable = literal >> 1;
+    values[literal] = 1;
+    values[satsolver_negate(literal)] = -1;
+    level[variable] = decisionLevel();
+    reason[variable] = reasonClause;
+    trail.push_back(literal);
+}
+
+void SatSolver::newDecisionLevel()
+{
+    trailLimits.push_back((int) trail.size());
+}
+
+/**
+ * Unassigns the variables above the given level, saving their phases.
+ */
+void SatSolver::cancelUntil(int targetLevel)
+{
+    if (decisionLevel() <= targetLevel) return;
+    for (int i = (int) trail.size() - 1; i >= trailLimits[targetLevel]; --i)
+    {
+        int literal = trail[i];
+        int variable = literal >> 1;
+        values[literal] = 0;
+        values[satsolver_negate(literal)] = 0;
+        savedNegated[variable] = literal & 1;
+        if (heapPosition[variable] == -1) heapInsert(variable);
+    }
+    trail.resize(trailLimits[targetLevel]);
+    trailLimits.resize(targetLevel);
+    propagated = trail.size();
+}
+
+int SatSolver::attachClause(const std::vector<int>& clauseLiterals, bool learnt,
+        int lbd)
+{
+    Clause clause;
+    clause.start = literals.size();
+    clause.size = (int) clauseLiterals.size();
+    clause.lbd = lbd;
+    clause.activity = 0.0f;
+    clause.learnt = learnt;
+    literals.insert(literals.end(), clauseLiterals.begin(), clauseLiterals.end());
+    clauses.push_back(clause);
+
+    int index = (int) clauses.size() - 1;
+    bool binary = clause.size == 2;
+    Watcher first = { index, clauseLiterals[1], binary };
+    Watcher second = { index, clauseLiterals[0], binary };
+    watches[clauseLiterals[0]].push_back(first);
+    watches[clauseLiterals[1]].push_back(second);
+    if (learnt) bumpClause(clauses.back());
+    return index;
+}
+
+bool SatSolver::addClause(const std::vector<int>& clauseLiterals)
+{
+    if (!ok) return false;
+
+    // Drop false literals and duplicates; satisfied clauses and tautologies
+    // add nothing
+    std::vector<int> kept;
+    for (unsigned int i = 0; i < clauseLiterals.size(); ++i)
+    {
+        int literal = clauseLiterals[i];
+        if (values[literal] == 1) return true;
+        if (values[literal] == 0) kept.push_back(literal);
+    }
+    std::sort(kept.begin(), kept.end());
+    kept.erase(std::unique(kept.begin(), kept.end()), kept.end());
+    for (unsigned int i = 1; i < kept.size(); ++i)
+    {
+        if (kept[i] == satsolver_negate(kept[i - 1])) return true;
+    }
+
+    if (kept.empty())
+    {
+        ok = false;
+    }
+    else if (kept.size() == 1)
+    {
+        assign(kept[0], -1);
+        ok = propagate() == -1;
+    }
+    else
+    {
+        attachClause(kept, false, 0);
+    }
+    return ok;
+}
+
+/**
+ * Propagates the assignments of the trail not yet propagated. Returns the
+ * clause in conflict, or -1 if there is none. The literal a clause implies
+ * is moved to its front, except in binary clauses, which are never read.
+ */
+int SatSolver::propagate()
+{
+    int conflict = -1;
+    while (propagated < trail.size())
+    {
+        int falseLiteral = satsolver_negate(trail[propagated++]);
+        std::vector<Watcher>& watchers = watches[falseLiteral];
+        size_t i = 0, j = 0, end = watchers.size();
+        while (i < end)
+        {
+            Watcher watcher = watchers[i++];
+            int blockerValue = values[watcher.blocker];
+            if (blockerValue == 1)
+            {
+                watchers[j++] = watcher;
+                continue;
+            }
+            if (watcher.binary)
+            {
+                watchers[j++] = watcher;
+                if (blockerValue == 0)
+                {
+                    assign(watcher.blocker, watcher.clause);
+                    continue;
+                }
+                conflict = watcher.clause;
+                propagated = trail.size();
+                while (i < end) watchers[j++] = watchers[i++];
+                break;
+            }
+
+            const Clause& clause = clauses[watcher.clause];
+            int* lits = &literals[clause.start];
+            if (lits[0] == falseLiteral) std::swap(lits[0], lits[1]);
+            int first = lits[0];
+            watcher.blocker = first;
+            if (values[first] == 1)
+            {
+                watchers[j++] = watcher;
+                continue;
+            }
+
+            // Watch another literal that is not false, if any
+            bool moved = false;
+            for (int k = 2; k < clause.size; ++k)
+            {
+                if (values[lits[k]] != -1)
+                {
+                    lits[1] = lits[k];
+                    lits[k] = falseLiteral;
+                    watches[lits[1]].push_back(watcher);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+
+            // The clause is unit or in conflict
+            watchers[j++] = watcher;
+            if (values[first] == -1)
+            {
+                conflict = watcher.clause;
+                propagated = trail.size();
+                while (i < end) watchers[j++] = watchers[i++];
+            }
+            else
+            {
+                assign(first, watcher.clause);
+            }
+        }
+        watchers.resize(j);
+    }
+    return conflict;
+}
+
+unsigned int SatSolver::abstractLevel(int variable) const
+{
+    return 1u << (level[variable] & 31);
+}
+
+/**
+ * Tells whether a literal of a learned clause follows from the others, by
+ * going through the reasons of the literals that imply it until reaching
+ * literals of the clause or of level 0. The levels of the clause, hashed
+ * into a mask, cut the search at literals that cannot be implied by them.
+ * Literals found redundant stay marked as seen and are added to analyzed.
+ */
+bool SatSolver::redundant(int literal, unsigned int levels)
+{
+    pending.assign(1, literal);
+    size_t top = analyzed.size();
+    while (!pending.empty())
+    {
+        int falseLiteral = pending.back();
+        pending.pop_back();
+        const Clause& clause = clauses[reason[falseLiteral >> 1]];
+        const int* lits = &literals[clause.start];
+        for (int k = 0; k < clause.size; ++k)
+        {
+            int variable = lits[k] >> 1;
+            if (variable == (falseLiteral >> 1) || seen[variable]
+                    || level[variable] == 0)
+                continue;
+            if (reason[variable] != -1 && (abstractLevel(variable) & levels) != 0)
+            {
+                seen[variable] = 1;
+                pending.push_back(lits[k]);
+                analyzed.push_back(lits[k]);
+            }
+            else
+            {
+                for (size_t i = top; i < analyzed.size(); ++i)
+                    seen[analyzed[i] >> 1] = 0;
+                analyzed.resize(top);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Learns the first-UIP clause of a conflict, with the asserting literal
+ * first and a literal of the level to go back to second, and gives that
+ * level and the number of levels in the clause (LBD).
+ */
+void SatSolver::analyze(int conflict, std::vector<int>& learnt,
+        int& backtrackLevel, int& lbd)
+{
+    learnt.assign(1, -1);
+    int pathCount = 0;
+    int literal = -1;
+    int index = (int) trail.size() - 1;
+    int clauseIndex = conflict;
+    do
+    {
+        Clause& clause = clauses[clauseIndex];
+        if (clause.learnt) bumpClause(clause);
+        const int* lits = &literals[clause.start];
+        for (int k = 0; k < clause.size; ++k)
+        {
+            int variable = lits[k] >> 1;
+            if (lits[k] == literal || seen[variable] || level[variable] == 0)
+                continue;
+            bumpVariable(variable);
+            seen[variable] = 1;
+            if (level[variable] >= decisionLevel())
+                pathCount++;
+            else
+                learnt.push_back(lits[k]);
+        }
+
+        // Next literal of the current level to resolve on
+        while (!seen[trail[index] >> 1]) index--;
+        literal = trail[index--];
+        clauseIndex = reason[literal >> 1];
+        seen[literal >> 1] = 0;
+        pathCount--;
+    } while (pathCount > 0);
+    learnt[0] = satsolver_negate(literal);
+
+    analyzed.assign(learnt.begin(), learnt.end());
+    unsigned int levels = 0;
+    for (size_t i = 1; i < learnt.size(); ++i)
+        levels |= abstractLevel(learnt[i] >> 1);
+    size_t kept = 1;
+    for (size_t i = 1; i < learnt.size(); ++i)
+    {
+        if (reason[learnt[i] >> 1] == -1 || !redundant(learnt[i], levels))
+            learnt[kept++] = learnt[i];
+    }
+    learnt.resize(kept);
+    for (size_t i = 1; i < analyzed.size(); ++i) seen[analyzed[i] >> 1] = 0;
+
+    backtrackLevel = 0;
+    if (learnt.size() > 1)
+    {
+        size_t highest = 1;
+        for (size_t i = 2; i < learnt.size(); ++i)
+        {
+            if (level[learnt[i] >> 1] > level[learnt[highest] >> 1]) highest = i;
+        }
+        std::swap(learnt[1], learnt[highest]);
+        backtrackLevel = level[learnt[1] >> 1];
+    }
+
+    if ((int) levelStamp.size() <= decisionLevel())
+        levelStamp.resize(decisionLevel() + 1, 0);
+    ++stamp;
+    lbd = 0;
+    for (size_t i = 0; i < learnt.size(); ++i)
+    {
+        int& levelMark = levelStamp[level[learnt[i] >> 1]];
+        if (levelMark != stamp)
+        {
+            levelMark = stamp;
+            lbd++;
+        }
+    }
+}
+
+int SatSolver::pickBranch()
+{
+    while (!heap.empty())
+    {
+        int variable = heapRemoveMax();
+        if (values[2 * variable] == 0)
+            return satsolver_literal(variable, savedNegated[variable] != 0);
+    }
+    return -1;
+}
+
+/**
+ * Searches until a model is found, the assumptions are refuted, the given
+ * number of conflicts is reached (UNKNOWN, to restart) or the deadline
+ * passes (UNKNOWN, with timedOut set). The assumptions are the decisions of
+ * the first levels.
+ */
+SatSolver::Result SatSolver::search(const std::vector<int>& assumptions,
+        long long maxConflicts, long long deadline)
+{
+    long long startConflicts = conflicts;
+    std::vector<int> learnt;
+    for (;;)
+    {
+        int conflict = propagate();
+        if (conflict != -1)
+        {
+            conflicts++;
+            if (decisionLevel() == 0)
+            {
+                ok = false;
+                return UNSATISFIABLE;
+            }
+
+            int backtrackLevel, lbd;
+            analyze(conflict, learnt, backtrackLevel, lbd);
+            cancelUntil(backtrackLevel);
+            if (learnt.size() == 1)
+                assign(learnt[0], -1);
+            else
+                assign(learnt[0], attachClause(learnt, true, lbd));
+            variableIncrement /= VARIABLE_DECAY;
+            clauseIncrement /= CLAUSE_DECAY;
+
+            if (deadline != 0 && conflicts % CLOCK_INTERVAL == 0
+                    && timing_now() > deadline)
+            {
+                timedOut = true;
+                return UNKNOWN;
+            }
+            continue;
+        }
+
+        if (conflicts - startConflicts >= maxConflicts) return UNKNOWN;
+        if (conflicts >= nextReduction)
+        {
+            reduceClauses();
+            numReductions++;
+            nextReduction = conflicts + FIRST_REDUCTION
+                    + (long long) REDUCTION_INCREMENT * numReductions;
+        }
+
+        int next = -1;
+        while (next == -1 && decisionLevel() < (int) assumptions.size())
+        {
+            int assumption = assumptions[decisionLevel()];
+            if (values[assumption] == 1)
+                newDecisionLevel();
+            else if (values[assumption] == -1)
+                return UNSATISFIABLE;
+            else
+                next = assumption;
+        }
+        if (next == -1)
+        {
+            next = pickBranch();
+            if (next == -1)
+            {
+                model.resize(numVariables());
+                for (int v = 0; v < numVariables(); ++v)
+                    model[v] = values[2 * v] == 1;
+                return SATISFIABLE;
+            }
+        }
+
+        decisions++;
+        if (deadline != 0 && decisions % CLOCK_INTERVAL == 0
+                && timing_now() > deadline)
+        {
+            timedOut = true;
+            return UNKNOWN;
+        }
+        newDecisionLevel();
+        assign(next, -1);
+    }
+}
+
+/**
+ * Tells whether a clause is the reason of an assignment, whose literal is
+ * then one of the two watched ones.
+ */
+bool SatSolver::locked(int clauseIndex) const
+{
+    const int* lits = &literals[clauses[clauseIndex].start];
+    for (int k = 0; k < 2; ++k)
+    {
+        if (values[lits[k]] == 1 && reason[lits[k] >> 1] == clauseIndex)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Removes half of the learned clauses, those of highest LBD and then of
+ * lowest activity, sparing the reasons of assignments. At level 0 it also
+ * removes the clauses satisfied there and drops their false literals; the
+ * watched literals are not false after propagation, so they stay first.
+ */
+void SatSolver::reduceClauses()
+{
+    std::vector<int> candidates;
+    for (size_t i = 0; i < clauses.size(); ++i)
+    {
+        if (clauses[i].learnt && clauses[i].lbd > KEEP_LBD && !locked((int) i))
+            candidates.push_back((int) i);
+    }
+    std::sort(candidates.begin(), candidates.end(), WorseClause(clauses));
+    std::vector<int> newIndex(clauses.size(), 0);
+    for (size_t i = 0; i < candidates.size() / 2; ++i)
+        newIndex[candidates[i]] = -1;
+
+    bool simplify = decisionLevel() == 0;
+    std::vector<int> keptLiterals;
+    std::vector<Clause> keptClauses;
+    for (size_t i = 0; i < clauses.size(); ++i)
+    {
+        if (newIndex[i] == -1) continue;
+        Clause clause = clauses[i];
+        const int* lits = &literals[clause.start];
+        bool satisfied = false;
+        for (int k = 0; k < clause.size && simplify && !satisfied; ++k)
+            satisfied = values[lits[k]] == 1;
+        if (satisfied)
+        {
+            newIndex[i] = -1;
+            continue;
+        }
+
+        size_t start = keptLiterals.size();
+        for (int k = 0; k < clause.size; ++k)
+        {
+            if (!simplify || values[lits[k]] != -1) keptLiterals.push_back(lits[k]);
+        }
+        clause.start = start;
+        clause.size = (int) (keptLiterals.size() - start);
+        newIndex[i] = (int) keptClauses.size();
+        keptClauses.push_back(clause);
+    }
+    literals.swap(keptLiterals);
+    clauses.swap(keptClauses);
+
+    for (size_t l = 0; l < watches.size(); ++l) watches[l].clear();
+    for (size_t i = 0; i < clauses.size(); ++i)
+    {
+        const int* lits = &literals[clauses[i].start];
+        bool binary = clauses[i].size == 2;
+        Watcher first = { (int) i, lits[1], binary };
+        Watcher second = { (int) i, lits[0], binary };
+        watches[lits[0]].push_back(first);
+        watches[lits[1]].push_back(second);
+    }
+    for (size_t i = 0; i < trail.size(); ++i)
+    {
+        int& reasonClause = reason[trail[i] >> 1];
+        if (reasonClause != -1) reasonClause = newIndex[reasonClause];
+    }
+}
+
+SatSolver::Result SatSolver::solve(const std::vector<int>& assumptions,
+        long long deadline)
+{
+    model.clear();
+    timedOut = false;
+    if (!ok) return UNSATISFIABLE;
+
+    Result result = UNKNOWN;
+    for (int restart = 0; result == UNKNOWN && !timedOut; ++restart)
+    {
+        result = search(assumptions, luby(restart) * RESTART_BASE, deadline);
+        if (result == UNKNOWN) cancelUntil(0);
+    }
+    cancelUntil(0);
+    return result;
+}
+
+void SatSolver::bumpVariable(int variable)
+{
+    activity[variable] += variableIncrement;
+    if (activity[variable] > 1e100)
+    {
+        for (size_t v = 0; v < activity.size(); ++v) activity[v] *= 1e-100;
+        variableIncrement *= 1e-100;
+    }
+    if (heapPosition[variable] != -1) heapUp(heapPosition[variable]);
+}
+
+void SatSolver::bumpClause(Clause& clause)
+{
+    clause.activity += clauseIncrement;
+    if (clause.activity > 1e20f)
+    {
+        for (size_t i = 0; i < clauses.size(); ++i)
+        {
+            if (clauses[i].learnt) clauses[i].activity *= 1e-20f;
+        }
+        clauseIncrement *= 1e-20f;
+    }
+}
+
+void SatSolver::heapInsert(int variable)
+{
+    heap.push_back(variable);
+    heapPosition[variable] = (int) heap.size() - 1;
+    heapUp((int) heap.size() - 1);
+}
+
+int SatSolver::heapRemoveMax()
+{
+    int variable = heap[0];
+    int last = heap.back();
+    heap.pop_back();
+    heapPosition[variable] = -1;
+    if (!heap.empty())
+    {
+        heap[0] = last;
+        heapPosition[last] = 0;
+        heapDown(0);
+    }
+    return variable;
+}
+
+void SatSolver::heapUp(int position)
+{
+    int variable = heap[position];
+    while (position > 0)
+    {
+        int parent = (position - 1) / 2;
+        if (activity[heap[parent]] >= activity[variable]) break;
+        heap[position] = heap[parent];
+        heapPosition[heap[position]] = position;
+        position = parent;
+    }
+    heap[position] = variable;
+    heapPosition[variable] = position;
+}
+
+void SatSolver::heapDown(int position)
+{
+    int variable = heap[position];
+    int size = (int) heap.size();
+    for (;;)
+    {
+        int child = 2 * position + 1;
+        if (child >= size) break;
+        if (child + 1 < size && activity[heap[child + 1]] > activity[heap[child]])
+            child++;
+        if (activity[heap[child]] <= activity[variable]) break;
+        heap[position] = heap[child];
+        heapPosition[heap[position]] = position;
+        position = child;
+    }
+    heap[position] = variable;
+    heapPosition[variable] = position;
+}
@@ -0,0 +1,150 @@
+#ifndef SATSOLVER_H_
+#define SATSOLVER_H_
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * Literal of a variable: 2 * variable when positive, 2 * variable + 1 when
+ * negated.
+ */
+inline int satsolver_literal(int variable, bool negated)
+{
+    return 2 * variable + (negated ? 1 : 0);
+}
+
+inline int satsolver_negate(int literal)
+{
+    return literal ^ 1;
+}
+
+/**
+ * Incremental CDCL SAT solver: two watched literals with blockers and a
+ * shortcut for binary clauses, first-UIP learning with recursive clause
+ * minimization, VSIDS with phase saving, Luby restarts and periodic removal
+ * of the learned clauses of high LBD. Clauses can be added
+ * between calls to solve, and each call can assume some literals; learned
+ * clauses never depend on the assumptions, so they are kept for later calls.
+ */
+class SatSolver
+{
+public:
+    enum Result { SATISFIABLE, UNSATISFIABLE, UNKNOWN };
+
+    SatSolver();
+
+    int newVariable();
+    int numVariables() const;
+
+    // Value tried first when deciding on the variable, until the search
+    // assigns it and saves the value it had instead
+    void setPhase(int variable, bool value);
+
+    // Returns false if the clauses are unsatisfiable at level 0
+    bool addClause(const std::vector<int>& literals);
+
+    // Gives UNKNOWN if the deadline (of timing_now, 0 for none) is reached
+    Result solve(const std::vector<int>& assumptions, long long deadline);
+
+    // Value of a variable in the model of the last satisfiable call
+    bool modelValue(int variable) const;
+
+    long long numConflicts() const;
+
+private:
+    struct Clause
+    {
+        size_t start;
+        int size;
+        int lbd;
+        float activity;
+        bool learnt;
+    };
+
+    // The blocker is the other literal of a binary clause, which is then
+    // never read
+    struct Watcher
+    {
+        int clause;
+        int blocker;
+        bool binary;
+    };
+
+    // Orders learned clauses by decreasing LBD, then increasing activity
+    struct WorseClause
+    {
+        const std::vector<Clause>& clauses;
+
+        WorseClause(const std::vector<Clause>& clauses) : clauses(clauses) {}
+
+        bool operator()(int a, int b) const
+        {
+            if (clauses[a].lbd != clauses[b].lbd)
+                return clauses[a].lbd > clauses[b].lbd;
+            return clauses[a].activity < clauses[b].activity;
+        }
+    };
+
+    int decisionLevel() const;
+    void assign(int literal, int reason);
+    void newDecisionLevel();
+    void cancelUntil(int level);
+    int attachClause(const std::vector<int>& literals, bool learnt, int lbd);
+    int propagate();
+    void analyze(int conflict, std::vector<int>& learnt, int& backtrackLevel,
+            int& lbd);
+    bool redundant(int literal, unsigned int levels);
+    unsigned int abstractLevel(int variable) const;
+    int pickBranch();
+    Result search(const std::vector<int>& assumptions, long long maxConflicts,
+            long long deadline);
+    bool locked(int clause) const;
+    void reduceClauses();
+
+    void bumpVariable(int variable);
+    void bumpClause(Clause& clause);
+    void heapInsert(int variable);
+    int heapRemoveMax();
+    void heapUp(int position);
+    void heapDown(int position);
+
+    bool ok;
+    bool timedOut;
+
+    // Clause literals, the first two of each being watched
+    std::vector<int> literals;
+    std::vector<Clause> clauses;
+    long long nextReduction;
+    int numReductions;
+    std::vector<std::vector<Watcher> > watches;
+
+    // Per literal: 1 if true, -1 if false, 0 if unassigned
+    std::vector<signed char> values;
+
+    // Per variable
+    std::vector<int> level;
+    std::vector<int> reason;
+    std::vector<char> savedNegated;
+    std::vector<char> seen;
+    std::vector<double> activity;
+    std::vector<int> heapPosition;
+
+    std::vector<int> trail;
+    std::vector<int> trailLimits;
+    size_t propagated;
+
+    std::vector<int> heap;
+    double variableIncrement;
+    float clauseIncrement;
+
+    std::vector<int> levelStamp;
+    int stamp;
+    std::vector<int> analyzed;
+    std::vector<int> pending;
+
+    std::vector<char> model;
+    long long conflicts;
+    long long decisions;
+};
+
+#endif /*SATSOLVER_H_*/
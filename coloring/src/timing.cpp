@@ -0,0 +1,95 @@
+#include "timing.h"
+#include <chrono>
+
+// Timing of the run executed by the current thread, or NULL if not timed
+thread_local Timing* currentTiming = NULL;
+
+Timing::Timing() :
+    run(0), start(0), parse(0), total(0), construction(0), iterations(0)
+{
+}
+
+/**
+ * Returns a monotonic timestamp in nanoseconds.
+ */
+long long timing_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Timing* timing_current()
+{
+    return currentTiming;
+}
+
+/**
+ * Sets the timing that receives the phases recorded by the current thread.
+ * Threads that work on parts of the same run share its timing.
+ */
+void timing_setCurrent(Timing* timing)
+{
+    currentTiming = timing;
+}
+
+/**
+ * Takes the time and hardware counts at the start of a phase.
+ */
+void timing_beginPhase(PhaseStart& phase)
+{
+    hwcounters_read(phase.counts);
+    phase.time = timing_now();
+}
+
+/**
+ * Returns the hardware counts since the start of the phase.
+ */
+HwCounts phaseCounts(const PhaseStart& phase)
+{
+    HwCounts counts;
+    hwcounters_read(counts);
+    hwcounters_subtract(counts, phase.counts);
+    return counts;
+}
+
+/**
+ * Records the time spent parsing the instance.
+ */
+void timing_endParse(const PhaseStart& phase)
+{
+    if (currentTiming == NULL) return;
+    HwCounts counts = phaseCounts(phase);
+    long long elapsed = timing_now() - phase.time;
+    std::lock_guard<std::mutex> lock(currentTiming->mutex);
+    currentTiming->parse += elapsed;
+    hwcounters_add(currentTiming->parseCounts, counts);
+}
+
+/**
+ * Records time spent in a constructive heuristic (DSATUR or RLF).
+ */
+void timing_addConstruction(const PhaseStart& phase)
+{
+    if (currentTiming == NULL) return;
+    HwCounts counts = phaseCounts(phase);
+    long long elapsed = timing_now() - phase.time;
+    std::lock_guard<std::mutex> lock(currentTiming->mutex);
+    currentTiming->construction += elapsed;
+    hwcounters_add(currentTiming->constructionCounts, counts);
+}
+
+/**
+ * Records time spent and iterations performed in one local search round
+ * trying k colors.
+ */
+void timing_addRound(int k, const PhaseStart& phase, long long iterations)
+{
+    if (currentTiming == NULL) return;
+    HwCounts counts = phaseCounts(phase);
+    long long elapsed = timing_now() - phase.time;
+    std::lock_guard<std::mutex> lock(currentTiming->mutex);
+    currentTiming->iterations += iterations;
+    currentTiming->roundK.push_back(k);
+    currentTiming->roundTime.push_back(elapsed);
+    currentTiming->roundCounts.push_back(counts);
+}
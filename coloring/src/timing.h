@@ -0,0 +1,53 @@
+#ifndef TIMING_H_
+#define TIMING_H_
+
+#include <vector>
+#include <mutex>
+
+#include "hwcounters.h"
+
+/**
+ * Time and hardware counts at the start of a phase.
+ */
+struct PhaseStart
+{
+    long long time;
+    HwCounts counts;
+};
+
+/**
+ * Monotonic times, in nanoseconds, spent in each phase of one run, and the
+ * number of local search iterations performed. The algorithms record their
+ * phases into the timing of the current thread, if the driver has set one.
+ * The run number and start time identify the run in traces. When hardware
+ * counters are enabled, their counts are kept for the same phases.
+ */
+struct Timing
+{
+    int run;
+    long long start;
+    long long parse;
+    long long total;
+    long long construction;
+    long long iterations;
+    std::vector<int> roundK;
+    std::vector<long long> roundTime;
+    HwCounts parseCounts;
+    HwCounts constructionCounts;
+    std::vector<HwCounts> roundCounts;
+    std::mutex mutex;
+
+    Timing();
+};
+
+long long timing_now();
+
+Timing* timing_current();
+void timing_setCurrent(Timing* timing);
+
+void timing_beginPhase(PhaseStart& phase);
+void timing_endParse(const PhaseStart& phase);
+void timing_addConstruction(const PhaseStart& phase);
+void timing_addRound(int k, const PhaseStart& phase, long long iterations);
+
+#endif /*TIMING_H_*/
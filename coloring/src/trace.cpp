@@ -0,0 +1,143 @@
+#include "trace.h"
+#include "timing.h"
+#include <fstream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+// Events buffered per thread (a power of two)
+#define TRACE_RING_SIZE 4096
+
+struct TraceEvent
+{
+    int run;
+    int k;
+    long long time;
+    long long iteration;
+    int bestConflicts;
+};
+
+/**
+ * Single-producer single-consumer ring: the searching thread advances head
+ * and the writer thread advances tail.
+ */
+struct TraceRing
+{
+    TraceEvent events[TRACE_RING_SIZE];
+    std::atomic<unsigned int> head;
+    std::atomic<unsigned int> tail;
+    std::atomic<long long> dropped;
+
+    TraceRing() : head(0), tail(0), dropped(0) {}
+};
+
+std::atomic<bool> tracing(false);
+std::ofstream traceOut;
+std::thread traceWriter;
+std::mutex ringsMutex;
+std::vector<TraceRing*> rings;
+thread_local TraceRing* threadRing = NULL;
+
+/**
+ * Writes the events buffered in all rings. Returns whether there was any.
+ */
+bool drainRings()
+{
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    bool found = false;
+    for (unsigned int i = 0; i < rings.size(); ++i)
+    {
+        TraceRing* ring = rings[i];
+        unsigned int tail = ring->tail.load(std::memory_order_relaxed);
+        unsigned int head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail)
+        {
+            const TraceEvent& event = ring->events[tail & (TRACE_RING_SIZE - 1)];
+            traceOut << event.run << "," << event.time << ","
+                    << event.iteration << "," << event.k << ","
+                    << event.bestConflicts << "\n";
+            found = true;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    return found;
+}
+
+void writeTrace()
+{
+    while (tracing.load(std::memory_order_acquire))
+    {
+        if (!drainRings())
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+/**
+ * Starts tracing to the given file, returning false if it cannot be written.
+ */
+bool trace_open(const char* fileName)
+{
+    traceOut.open(fileName, std::ofstream::out);
+    if (!traceOut.is_open()) return false;
+    traceOut << "run,time,iteration,k,best_conflicts\n";
+
+    tracing.store(true, std::memory_order_release);
+    traceWriter = std::thread(writeTrace);
+    return true;
+}
+
+/**
+ * Stops the writer thread after writing all pending events. The number of
+ * dropped events, if any, is written as a final comment line.
+ */
+void trace_close()
+{
+    if (!tracing.load(std::memory_order_acquire)) return;
+    tracing.store(false, std::memory_order_release);
+    traceWriter.join();
+    drainRings();
+
+    long long dropped = 0;
+    for (unsigned int i = 0; i < rings.size(); ++i)
+    {
+        dropped += rings[i]->dropped.load();
+        delete rings[i];
+    }
+    rings.clear();
+    if (dropped > 0) traceOut << "# dropped " << dropped << " events\n";
+    traceOut.close();
+}
+
+/**
+ * Records an event for the run of the current thread, as set in its timing.
+ */
+void trace_event(long long iteration, int k, int bestConflicts)
+{
+    if (!tracing.load(std::memory_order_relaxed)) return;
+
+    if (threadRing == NULL)
+    {
+        threadRing = new TraceRing();
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(threadRing);
+    }
+
+    unsigned int head = threadRing->head.load(std::memory_order_relaxed);
+    unsigned int tail = threadRing->tail.load(std::memory_order_acquire);
+    if (head - tail == TRACE_RING_SIZE)
+    {
+        threadRing->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Timing* timing = timing_current();
+    TraceEvent& event = threadRing->events[head & (TRACE_RING_SIZE - 1)];
+    event.run = (timing != NULL) ? timing->run : 0;
+    event.time = timing_now() - ((timing != NULL) ? timing->start : 0);
+    event.iteration = iteration;
+    event.k = k;
+    event.bestConflicts = bestConflicts;
+    threadRing->head.store(head + 1, std::memory_order_release);
+}
@@ -0,0 +1,18 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/**
+ * Optional trace of the search quality over time. Searches record an event
+ * whenever their best number of conflicts changes, and a background thread
+ * writes the events to a CSV file with the columns run, time (nanoseconds
+ * since the start of the run), iteration, k and best number of conflicts.
+ * Recording never blocks: events go to a per-thread ring buffer, and are
+ * dropped (and counted) when it is full.
+ */
+
+bool trace_open(const char* fileName);
+void trace_close();
+
+void trace_event(long long iteration, int k, int bestConflicts);
+
+#endif /*TRACE_H_*/
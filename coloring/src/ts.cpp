@@ -1,13 +1,213 @@
 #include "ts.h"
 #include "dsatur.h"
+#include "timing.h"
+#include "trace.h"
+#include "island.h"
+#include "checkpoint.h"
 #include <cstdlib>
+#include <csignal>
+#include <string>
 #include <utility>
 #include <vector>
 #include <list>
 #include <set>
 #include <algorithm>
+#include <limits>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
-void resetCountAdjColors(const Solution& solution, char** countAdjColors,
+// When compiled with TS_COUNTERS, the tabu search counts what happens in its
+// inner loops. Counters are kept per thread and summarized after each round.
+#ifdef TS_COUNTERS
+struct TsCounters
+{
+    long long iterations;
+    long long evaluatedMoves;
+    long long cachedVertices;
+    long long tabuRejectedMoves;
+    long long aspirationAccepts;
+    long long improvements;
+    long long conflictingSum;
+    long long maxConflicting;
+    long long tenureSum;
+    long long revisits;
+};
+thread_local TsCounters counters;
+#define TS_COUNT(counter, amount) (counters.counter += (amount))
+#define TS_COUNT_MAX(counter, value) \
+    do { if ((value) > counters.counter) counters.counter = (value); } while (0)
+
+/**
+ * Adds the counters of another thread, such as a thread of a team sharing
+ * the scans of the search.
+ */
+void mergeCounters(TsCounters& into, const TsCounters& from)
+{
+    into.iterations += from.iterations;
+    into.evaluatedMoves += from.evaluatedMoves;
+    into.cachedVertices += from.cachedVertices;
+    into.tabuRejectedMoves += from.tabuRejectedMoves;
+    into.aspirationAccepts += from.aspirationAccepts;
+    into.improvements += from.improvements;
+    into.conflictingSum += from.conflictingSum;
+    into.maxConflicting = std::max(into.maxConflicting, from.maxConflicting);
+    into.tenureSum += from.tenureSum;
+    into.revisits += from.revisits;
+}
+#else
+#define TS_COUNT(counter, amount) ((void) 0)
+#define TS_COUNT_MAX(counter, value) ((void) 0)
+#endif
+
+// Iterations between dumps of the counters to stderr (0 disables them)
+int counterDumpInterval = 0;
+
+// Algorithm giving the first feasible solution
+ColoringAlgorithm initialAlgorithm = dsatur_constructSolution;
+
+// Bound on the iterations of each tabu search round of the current thread,
+// or 0 for none. Bounded rounds also stop as soon as no conflict is left.
+thread_local long long iterationLimit = 0;
+
+// Slots of the table of recently visited colorings (a power of two)
+#define VISITED_TABLE_SIZE 65536
+
+// The tabu tenure is the number of conflicting vertices times k over 15,
+// scaled by a factor that grows when colorings are revisited and shrinks
+// after a while without revisits, within these bounds. The tabu list loses
+// at most one move per iteration, so a shorter tenure first stops its growth.
+#define MIN_TENURE_FACTOR 0.25
+#define MAX_TENURE_FACTOR 2.0
+#define TENURE_INCREASE 1.1
+#define TENURE_DECREASE 0.9
+
+// Iterations without revisits before the tenure shrinks, besides twice the
+// average length of the cycles seen
+#define MIN_REACTION_INTERVAL 100
+
+// Fewest vertices whose moves must be found again for which the scan of an
+// iteration is shared by the team of threads of the search
+#define MIN_SHARED_SCAN 1024
+
+// Polls of the searching thread waiting for the team before it starts
+// yielding the processor
+#define SPINS_BEFORE_YIELD 1000
+
+// Polls of a team thread waiting for the next scan before it sleeps
+#define SPINS_BEFORE_SLEEP 10000
+
+// Conflicting vertices from which the best move is looked up in buckets of
+// cached moves instead of scanned for, until they fall below half as many
+#define MIN_BUCKETED_CONFLICTS 256
+
+// Threads sharing the scan of the vertices whose moves changed in each
+// iteration
+int scanThreads = 1;
+
+// Iterations between looks at the clock for checkpoints
+#define CHECKPOINT_CLOCK_INTERVAL 1024
+
+// File where the descent saves its state (empty for none), nanoseconds
+// between saves, and state to start from (NULL to run the initial
+// algorithm). Checkpoints are only taken by single runs on whole instances.
+std::string checkpointFileName;
+long long checkpointInterval = 0;
+const TsCheckpoint* startCheckpoint = NULL;
+volatile sig_atomic_t terminationRequested = 0;
+
+// Best feasible solution of the descent of the current thread while it
+// takes checkpoints, the next time to take one, and the saved round to
+// continue, if any
+thread_local const Solution* checkpointFeasible = NULL;
+thread_local long long nextCheckpointTime = 0;
+thread_local const TsCheckpoint* resumedRound = NULL;
+
+thread_local TsRandom tsRandom;
+
+void requestTermination(int signum)
+{
+    terminationRequested = 1;
+}
+
+void ts_setInitialAlgorithm(ColoringAlgorithm algorithm)
+{
+    initialAlgorithm = algorithm;
+}
+
+void ts_setCounterDumpInterval(int iterations)
+{
+    counterDumpInterval = iterations;
+}
+
+void ts_setScanThreads(int threads)
+{
+    scanThreads = std::max(1, threads);
+}
+
+/**
+ * Saves the state of the descent to the given file every given number of
+ * seconds, and when SIGTERM is received, after which the process terminates.
+ * SIGTERM is only caught while the descent runs; before it there is nothing
+ * to save.
+ */
+void ts_setCheckpoint(const char* fileName, double intervalSeconds)
+{
+    checkpointFileName = fileName;
+    checkpointInterval = (long long) (intervalSeconds * 1e9);
+}
+
+/**
+ * Ends the process as SIGTERM would have, once its state is saved.
+ */
+void terminateIfRequested()
+{
+    if (!terminationRequested) return;
+    signal(SIGTERM, SIG_DFL);
+    raise(SIGTERM);
+}
+
+/**
+ * Starts the descent from a saved feasible coloring instead of running the
+ * initial algorithm, continuing the saved round if there is one.
+ */
+void ts_setStart(const TsCheckpoint* checkpoint)
+{
+    startCheckpoint = checkpoint;
+}
+
+#ifdef TS_COUNTERS
+/**
+ * Writes the counters of the current thread to stderr in a single line.
+ */
+void dumpCounters(const char* label, const int k, const long long it)
+{
+    long long iterations = std::max(1LL, counters.iterations);
+    std::ostringstream line;
+    line << "ts " << label << " k=" << k << " it=" << it
+            << " iterations=" << counters.iterations
+            << " evaluated=" << counters.evaluatedMoves
+            << " cached=" << counters.cachedVertices
+            << " tabuRejected=" << counters.tabuRejectedMoves
+            << " aspiration=" << counters.aspirationAccepts
+            << " improvements=" << counters.improvements
+            << " avgConflicting=" << counters.conflictingSum / iterations
+            << " maxConflicting=" << counters.maxConflicting
+            << " avgTenure=" << counters.tenureSum / iterations
+            << " revisits=" << counters.revisits
+            << " cycleRate=" << (double) counters.revisits / iterations << std::endl;
+    std::cerr << line.str();
+}
+#endif
+
+/**
+ * Sets the counts of adjacent colors of every vertex for the first k colors.
+ */
+template <typename Rows>
+void resetCountAdjColors(const Solution& solution, Rows& countAdjColors,
         const int k)
 {
     // Clear counts
@@ -31,8 +231,9 @@ void resetCountAdjColors(const Solution& solution, char** countAdjColors,
     }
 }
 
-void resetConflictingVertices(const Solution& solution, char** countAdjColors,
-        std::set<int>& conflictingVertices)
+template <typename Rows, typename Conflicts>
+void resetConflictingVertices(const Solution& solution, Rows& countAdjColors,
+        Conflicts& conflictingVertices)
 {
     conflictingVertices.clear();
     for (int u = 0; u < solution.instance->nvertices; ++u)
@@ -44,6 +245,22 @@ void resetConflictingVertices(const Solution& solution, char** countAdjColors,
     }
 }
 
+/**
+ * Renumbers the colors from 0 in order of appearance, so that a solution with
+ * k colors only uses colors below k.
+ */
+void compactColors(Solution& solution)
+{
+    std::vector<int> newColor(solution.instance->nvertices, -1);
+    int numColors = 0;
+    for (int u = 0; u < solution.instance->nvertices; ++u)
+    {
+        int& color = newColor[solution.coloring[u]];
+        if (color == -1) color = numColors++;
+        solution.coloring[u] = color;
+    }
+}
+
 void decrementK(Solution& solution)
 {
     int k = solution.k();
@@ -61,7 +278,7 @@ void decrementK(Solution& solution)
         if (solution.coloring[u] == biggestColorClass)
         {
             // Distribute vertices of the biggest color class randomly
-            solution.coloring[u] = rand() % (k - 1);
+            solution.coloring[u] = tsRandom(k - 1);
         }
         else if (solution.coloring[u] == (k - 1))
         {
@@ -94,61 +311,186 @@ int calculateValue(const Solution& solution)
     return value;
 }
 
-void chooseBestMove(const Solution& solution, char** countAdjColors,
-        const std::set<int>& conflictingVertices, const int diffToBestValue,
-        const std::list<std::pair<int, int> >& tabuList, const int k,
-        std::pair<int, int>& bestMove, int& bestMoveDelta)
+int maxDegree(const Instance* instance)
 {
-    std::vector<int> vertices(conflictingVertices.begin(), conflictingVertices.end());
-    std::random_shuffle(vertices.begin(), vertices.end());
+    int maxDegree = 0;
+    for (int u = 0; u < instance->nvertices; ++u)
+        maxDegree = std::max(maxDegree, instance->gamma[u][0]);
+    return maxDegree;
+}
 
-    std::pair<int, int> move;
-    for (std::vector<int>::iterator vertexIt = vertices.begin(); vertexIt != vertices.end(); ++vertexIt)
+/**
+ * Zobrist key of vertex u having the given color. Keys are mixed from the
+ * pair (splitmix64) rather than stored, since a table would take n * k words.
+ */
+inline unsigned long long zobristKey(int u, int color)
+{
+    unsigned long long key = ((unsigned long long) u << 32) | (unsigned int) color;
+    key += 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+}
+
+/**
+ * Hash of a coloring: the exclusive or of the keys of all its vertices, so
+ * that a move updates it with two keys.
+ */
+unsigned long long hashColoring(const Solution& solution)
+{
+    unsigned long long hash = 0;
+    for (int u = 0; u < solution.instance->nvertices; ++u)
+        hash ^= zobristKey(u, solution.coloring[u]);
+    return hash;
+}
+
+/**
+ * Slot of the table of recently visited colorings.
+ */
+struct VisitedColoring
+{
+    unsigned long long hash;
+    long long iteration;
+};
+
+/**
+ * Best move of each vertex among its non-tabu colors, and among its tabu
+ * colors for the aspiration criterion. The moves of a vertex are kept until
+ * a move changes the counts of its adjacent colors or one of its tabu moves
+ * expires, so that move selection is mostly a scan of cached deltas. With
+ * many conflicting vertices, the vertices whose moves were dropped are
+ * queued instead, so that an iteration only finds the moves of those again
+ * and looks the best one up (see MoveBuckets).
+ */
+struct MoveCache
+{
+    int rowLength;
+    
+    // Times each move (u, color) is in the tabu list, in rows laid out as
+    // those of the counts of adjacent colors
+    std::vector<int> tabuCount;
+    
+    // Per vertex; the colors are -1 if there is no such move
+    std::vector<char> valid;
+    std::vector<int> bestColor;
+    std::vector<int> bestDelta;
+    std::vector<int> tabuColor;
+    std::vector<int> tabuDelta;
+    
+    // Vertices whose moves were dropped since they were last found, each
+    // queued once, while queueing
+    bool queueing;
+    std::vector<int> dirty;
+    std::vector<char> queued;
+    
+    MoveCache(int nvertices, int rowLength) :
+        rowLength(rowLength), tabuCount((size_t) nvertices * rowLength, 0),
+        valid(nvertices, 0), bestColor(nvertices), bestDelta(nvertices),
+        tabuColor(nvertices), tabuDelta(nvertices), queueing(false),
+        queued(nvertices, 0) {}
+    
+    void invalidate(int u)
     {
-        int u = *vertexIt;
-        int currentColor = solution.coloring[u];
-        int currentConflicts = countAdjColors[u][currentColor];
-        
-        int randomJump = rand();
-        for (int i = 0; i < k; ++i)
+        valid[u] = 0;
+        if (queueing && !queued[u])
         {
-            int newColor = (i + randomJump) % k;
-            
-            if (newColor == currentColor) continue;
-            move = std::make_pair(u, newColor);
-            int newConflicts = countAdjColors[u][newColor];
-            int delta = newConflicts - currentConflicts;
-            
-            // If the neighbour solution is better than the current, move to it
-            if (delta < 0)
-            {
-                // Ignore if this move is tabu and the neighbor solution
-                // doesn't represent a global improvement
-                bool isTabu = (std::find(tabuList.begin(), tabuList.end(), move) != tabuList.end());
-                if (isTabu && (diffToBestValue + delta >= 0))
-                    continue;
-                
-                bestMove = move;
-                bestMoveDelta = delta;
-                break;
-            }                
-            // Otherwise, keep looking for the best neighbour
-            else if (bestMove.first == -1 || delta < bestMoveDelta)
-            {
-                // Ignore if this move is tabu
-                bool isTabu = (std::find(tabuList.begin(), tabuList.end(), move) != tabuList.end());
-                if (isTabu) continue;
-                
-                bestMove = move;
-                bestMoveDelta = delta;
-            }
+            queued[u] = 1;
+            dirty.push_back(u);
         }
     }
+    
+    void addTabu(const std::pair<int, int>& move)
+    {
+        tabuCount[(size_t) move.first * rowLength + move.second] += 1;
+    }
+    
+    void removeTabu(const std::pair<int, int>& move)
+    {
+        tabuCount[(size_t) move.first * rowLength + move.second] -= 1;
+        invalidate(move.first);
+    }
+};
 
-}
+/**
+ * Vertices in buckets by the delta of one of their cached moves, so that the
+ * best move is looked up rather than scanned for. Deltas lie within the
+ * maximum degree on either side of 0. Buckets are unordered, and a vertex
+ * leaves one by swapping with the last, so that one can be drawn uniformly.
+ */
+struct MoveBuckets
+{
+    int offset;
+    std::vector<std::vector<int> > buckets;
+    
+    // Bucket of each vertex (-1 if in none) and index within it
+    std::vector<int> bucketOf;
+    std::vector<int> position;
+    
+    // No bucket below this one holds a vertex
+    int lowest;
+    
+    MoveBuckets(int nvertices, int maxDegree) :
+        offset(maxDegree), buckets(2 * maxDegree + 1),
+        bucketOf(nvertices, -1), position(nvertices), lowest(buckets.size()) {}
+    
+    void insert(int u, int delta)
+    {
+        int bucket = delta + offset;
+        bucketOf[u] = bucket;
+        position[u] = buckets[bucket].size();
+        buckets[bucket].push_back(u);
+        lowest = std::min(lowest, bucket);
+    }
+    
+    void erase(int u)
+    {
+        if (bucketOf[u] == -1) return;
+        std::vector<int>& bucket = buckets[bucketOf[u]];
+        int last = bucket.back();
+        bucket[position[u]] = last;
+        position[last] = position[u];
+        bucket.pop_back();
+        bucketOf[u] = -1;
+    }
+    
+    // Returns the lowest bucket holding a vertex, or -1 if all are empty
+    int lowestBucket()
+    {
+        while (lowest < (int) buckets.size() && buckets[lowest].empty()) ++lowest;
+        return (lowest < (int) buckets.size()) ? lowest : -1;
+    }
+    
+    int delta(int bucket) const
+    {
+        return bucket - offset;
+    }
+    
+    void clear()
+    {
+        for (int bucket = lowest; bucket < (int) buckets.size(); ++bucket)
+        {
+            for (size_t i = 0; i < buckets[bucket].size(); ++i)
+                bucketOf[buckets[bucket][i]] = -1;
+            buckets[bucket].clear();
+        }
+        lowest = buckets.size();
+    }
+    
+    int draw(int bucket)
+    {
+        return buckets[bucket][tsRandom(buckets[bucket].size())];
+    }
+};
 
-void applyMove(Solution& solution, char** countAdjColors,
-        std::set<int>& conflictingVertices, const std::pair<int, int>& move)
+/**
+ * Moves a vertex to a new color, updating the counts of adjacent colors and
+ * the conflicting vertices, and dropping the cached moves of the vertices
+ * whose counts change, if a cache is given.
+ */
+template <typename Rows, typename Conflicts>
+void moveVertex(Solution& solution, Rows& countAdjColors,
+        Conflicts& conflictingVertices, const std::pair<int, int>& move,
+        MoveCache* cache)
 {
     int u = move.first;
     int newColor = move.second;
@@ -166,6 +508,7 @@ void applyMove(Solution& solution, char** countAdjColors,
     for (int *it = (adj + 1), *end = (it + adj[0]); it != end; ++it)
     {
         int v = *it;
+        if (cache != NULL) cache->invalidate(v);
         countAdjColors[v][oldColor] -= 1;
         countAdjColors[v][newColor] += 1;
         
@@ -183,6 +526,8 @@ void applyMove(Solution& solution, char** countAdjColors,
         }
     }
     
+    if (cache != NULL) cache->invalidate(u);
+    
     // If the new color causes no conflict for vertex u
     if (countAdjColors[u][newColor] == 0)
     {
@@ -190,44 +535,567 @@ void applyMove(Solution& solution, char** countAdjColors,
     }
 }
 
-void tabuSearch(Solution& bestSolution, char** countAdjColors,
-        std::set<int>& conflictingVertices, const int k)
+template <typename Count>
+void applyMove(Solution& solution, CountTable<Count, 0>& countAdjColors,
+        ConflictList& conflictingVertices, const std::pair<int, int>& move)
 {
-    int bestValue = calculateValue(bestSolution);
+    moveVertex(solution, countAdjColors, conflictingVertices, move, NULL);
+}
+
+template void applyMove(Solution& solution,
+        CountTable<unsigned char, 0>& countAdjColors,
+        ConflictList& conflictingVertices, const std::pair<int, int>& move);
+template void applyMove(Solution& solution,
+        CountTable<unsigned short, 0>& countAdjColors,
+        ConflictList& conflictingVertices, const std::pair<int, int>& move);
+template void applyMove(Solution& solution, CountTable<int, 0>& countAdjColors,
+        ConflictList& conflictingVertices, const std::pair<int, int>& move);
+
+/**
+ * Finds the best moves of vertex u. The fewest conflicts among the non-tabu
+ * and the tabu colors come from a branch-free pass over the whole row, with
+ * the current color hidden, and a color having them is then taken starting
+ * from a random one.
+ */
+template <typename Count, int ROW>
+void updateMoves(const Solution& solution, CountTable<Count, ROW>& countAdjColors,
+        MoveCache& cache, const int k, const int u)
+{
+    const int length = countAdjColors.length();
+    const int none = std::numeric_limits<Count>::max();
+    Count* row = countAdjColors[u];
+    const int* tabu = &cache.tabuCount[(size_t) u * length];
+    int currentColor = solution.coloring[u];
+    int currentConflicts = row[currentColor];
+    
+    row[currentColor] = none;
+    int bestConflicts = none;
+    int tabuConflicts = none;
+    for (int c = 0; c < length; ++c)
+    {
+        int conflicts = row[c];
+        bool isTabu = tabu[c] != 0;
+        bestConflicts = std::min(bestConflicts, isTabu ? none : conflicts);
+        tabuConflicts = std::min(tabuConflicts, isTabu ? conflicts : none);
+    }
+    row[currentColor] = currentConflicts;
+    TS_COUNT(evaluatedMoves, k - 1);
+    
+    int bestColor = -1;
+    int tabuColor = -1;
+    bool bestFound = bestConflicts == none;
+    bool tabuFound = tabuConflicts == none;
+    int randomJump = tsRandom(k);
+    for (int i = 0; i < k && !(bestFound && tabuFound); ++i)
+    {
+        int newColor = i + randomJump;
+        if (newColor >= k) newColor -= k;
+        if (newColor == currentColor) continue;
+        
+        if (tabu[newColor] == 0)
+        {
+            if (!bestFound && row[newColor] == bestConflicts)
+            {
+                bestColor = newColor;
+                bestFound = true;
+            }
+        }
+        else if (!tabuFound && row[newColor] == tabuConflicts)
+        {
+            tabuColor = newColor;
+            tabuFound = true;
+        }
+    }
+    
+    cache.bestColor[u] = bestColor;
+    cache.bestDelta[u] = bestConflicts - currentConflicts;
+    cache.tabuColor[u] = tabuColor;
+    cache.tabuDelta[u] = tabuConflicts - currentConflicts;
+    cache.valid[u] = 1;
+}
+
+/**
+ * Move chosen in an iteration, its delta and the number of moves tied with
+ * it; the move is (-1, -1) if there is none that can be taken.
+ */
+struct ChosenMove
+{
+    std::pair<int, int> move;
+    int delta;
+    int numTies;
+    
+    ChosenMove() : move(-1, -1), delta(0), numTies(0) {}
+};
+
+/**
+ * Takes the best move of the given conflicting vertices, ties broken at
+ * random. A tabu move is only taken if it leads to a better solution than
+ * the best one found (aspiration).
+ */
+template <typename Count, int ROW, typename Iterator>
+void scanMoves(const Solution& solution, CountTable<Count, ROW>& countAdjColors,
+        Iterator first, Iterator last, const int diffToBestValue,
+        MoveCache& cache, const int k, ChosenMove& result)
+{
+    for (Iterator vertexIt = first; vertexIt != last; ++vertexIt)
+    {
+        int u = *vertexIt;
+        if (!cache.valid[u])
+            updateMoves(solution, countAdjColors, cache, k, u);
+        else
+            TS_COUNT(cachedVertices, 1);
+        
+        int color = cache.bestColor[u];
+        int delta = cache.bestDelta[u];
+        if (cache.tabuColor[u] != -1 && diffToBestValue + cache.tabuDelta[u] < 0
+                && (color == -1 || cache.tabuDelta[u] < delta))
+        {
+            color = cache.tabuColor[u];
+            delta = cache.tabuDelta[u];
+            TS_COUNT(aspirationAccepts, 1);
+        }
+        else if (cache.tabuColor[u] != -1 && (color == -1 || cache.tabuDelta[u] < delta))
+        {
+            TS_COUNT(tabuRejectedMoves, 1);
+        }
+        if (color == -1) continue;
+        
+        if (result.numTies == 0 || delta < result.delta)
+        {
+            result.move = std::make_pair(u, color);
+            result.delta = delta;
+            result.numTies = 1;
+        }
+        else if (delta == result.delta && tsRandom(++result.numTies) == 0)
+        {
+            result.move = std::make_pair(u, color);
+        }
+    }
+}
+
+/**
+ * Writes the state of the descent of the current thread, whose round at k
+ * colors has performed the given number of iterations.
+ */
+void saveCheckpoint(const Solution& currentSolution,
+        const Solution& bestSolution,
+        const std::list<std::pair<int, int> >& tabuList, const int k,
+        long long iteration, long long lastImprovementIteration,
+        double tenureFactor)
+{
+    const Instance* instance = currentSolution.instance;
+    int n = instance->nvertices;
+    TsCheckpoint checkpoint;
+    checkpoint.nvertices = n;
+    checkpoint.nedges = instance->nedges;
+    checkpoint.feasibleColoring.assign(checkpointFeasible->coloring,
+            checkpointFeasible->coloring + n);
+    checkpoint.k = k;
+    checkpoint.iteration = iteration;
+    checkpoint.lastImprovementIteration = lastImprovementIteration;
+    checkpoint.currentColoring.assign(currentSolution.coloring,
+            currentSolution.coloring + n);
+    checkpoint.bestColoring.assign(bestSolution.coloring,
+            bestSolution.coloring + n);
+    checkpoint.tabuList.assign(tabuList.begin(), tabuList.end());
+    checkpoint.tenureFactor = tenureFactor;
+    checkpoint.randomState = tsRandom.state;
+
+    if (!checkpoint_write(checkpointFileName, checkpoint))
+        std::cerr << "Could not write checkpoint: " << checkpointFileName << std::endl;
+    nextCheckpointTime = timing_now() + checkpointInterval;
+}
+
+/**
+ * Writes the best feasible coloring of the descent of the current thread
+ * while no round is in progress.
+ */
+void saveFeasibleCheckpoint()
+{
+    const Instance* instance = checkpointFeasible->instance;
+    int n = instance->nvertices;
+    TsCheckpoint checkpoint;
+    checkpoint.nvertices = n;
+    checkpoint.nedges = instance->nedges;
+    checkpoint.feasibleColoring.assign(checkpointFeasible->coloring,
+            checkpointFeasible->coloring + n);
+
+    if (!checkpoint_write(checkpointFileName, checkpoint))
+        std::cerr << "Could not write checkpoint: " << checkpointFileName << std::endl;
+}
+
+/**
+ * Tabu search for a k-coloring on counts of adjacent colors of type Count in
+ * rows of ROW entries (see CountTable). The instance's degrees must be below
+ * the largest Count and, when ROW is not 0, the colors below ROW.
+ */
+template <typename Count, int ROW>
+struct TabuKernel
+{
+    CountTable<Count, ROW> countAdjColors;
+    std::set<int> conflictingVertices;
+    
+    // Team sharing the scans of large sets of vertices whose moves must be
+    // found again. The threads live as long as the kernel: each generation
+    // they scan their part of the vertices, while the searching thread scans
+    // the first one. Then they poll for a while, since shared scans tend to
+    // come in runs, and sleep until the next generation, so that a search
+    // whose scans are not shared leaves them asleep.
+    std::vector<std::thread> team;
+    std::mutex wakeupMutex;
+    std::condition_variable wakeup;
+    std::atomic<unsigned int> generation;
+    std::atomic<int> pendingParts;
+    std::atomic<bool> stopping;
+#ifdef TS_COUNTERS
+    // What each team thread counted in its last scan, added by the
+    // searching thread to its own counters
+    std::vector<TsCounters> teamCounters;
+#endif
+    
+    // Scan of the current generation
+    const Solution* scanSolution;
+    MoveCache* scanCache;
+    int scanK;
+    
+    TabuKernel(int nvertices, int k) :
+        countAdjColors(nvertices, k), generation(0), pendingParts(0),
+        stopping(false)
+#ifdef TS_COUNTERS
+        , teamCounters(scanThreads)
+#endif
+    {
+        for (int part = 1; part < scanThreads; ++part)
+        {
+            team.push_back(std::thread(&TabuKernel::work, this, part,
+                    tsRandom.next()));
+        }
+    }
+    
+    ~TabuKernel()
+    {
+        stopping.store(true, std::memory_order_relaxed);
+        startGeneration();
+        for (unsigned int i = 0; i < team.size(); ++i) team[i].join();
+    }
+    
+    void startGeneration()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wakeupMutex);
+            generation.fetch_add(1, std::memory_order_release);
+        }
+        wakeup.notify_all();
+    }
+    
+    void reset(const Solution& solution, const int k)
+    {
+        resetCountAdjColors(solution, countAdjColors, k);
+        const int length = countAdjColors.length();
+        for (int u = 0; u < solution.instance->nvertices; ++u)
+        {
+            std::fill(countAdjColors[u] + k, countAdjColors[u] + length,
+                    std::numeric_limits<Count>::max());
+        }
+        resetConflictingVertices(solution, countAdjColors, conflictingVertices);
+    }
+    
+    /**
+     * Finds the moves of the part of the queued vertices that are
+     * conflicting; the others are left out of the buckets until a move
+     * touches them again.
+     */
+    void scanPart(int part, int numParts)
+    {
+        const std::vector<int>& dirty = scanCache->dirty;
+        size_t begin = dirty.size() * part / numParts;
+        size_t end = dirty.size() * (part + 1) / numParts;
+        for (size_t i = begin; i < end; ++i)
+        {
+            int u = dirty[i];
+            if (countAdjColors[u][scanSolution->coloring[u]] != 0)
+                updateMoves(*scanSolution, countAdjColors, *scanCache, scanK, u);
+        }
+    }
+    
+    void work(int part, unsigned long long seed)
+    {
+        tsRandom.seed(seed);
+        unsigned int seen = 0;
+        while (true)
+        {
+            int spins = 0;
+            while (generation.load(std::memory_order_acquire) == seen
+                    && spins < SPINS_BEFORE_SLEEP)
+            {
+                ++spins;
+            }
+            if (spins == SPINS_BEFORE_SLEEP)
+            {
+                std::unique_lock<std::mutex> lock(wakeupMutex);
+                while (generation.load(std::memory_order_acquire) == seen)
+                    wakeup.wait(lock);
+            }
+            ++seen;
+            if (stopping.load(std::memory_order_relaxed)) return;
+            scanPart(part, team.size() + 1);
+#ifdef TS_COUNTERS
+            teamCounters[part] = counters;
+            counters = TsCounters();
+#endif
+            pendingParts.fetch_sub(1, std::memory_order_release);
+        }
+    }
+    
+    /**
+     * Starts looking moves up in the buckets: the conflicting vertices with
+     * cached moves are filed, and the others queued.
+     */
+    void startBuckets(MoveCache& cache, MoveBuckets& bestMoves,
+            MoveBuckets& tabuMoves)
+    {
+        cache.queueing = true;
+        for (std::set<int>::iterator vertexIt = conflictingVertices.begin();
+                vertexIt != conflictingVertices.end(); ++vertexIt)
+        {
+            int u = *vertexIt;
+            if (!cache.valid[u])
+            {
+                cache.invalidate(u);
+                continue;
+            }
+            if (cache.bestColor[u] != -1) bestMoves.insert(u, cache.bestDelta[u]);
+            if (cache.tabuColor[u] != -1) tabuMoves.insert(u, cache.tabuDelta[u]);
+        }
+    }
+    
+    void stopBuckets(MoveCache& cache, MoveBuckets& bestMoves,
+            MoveBuckets& tabuMoves)
+    {
+        cache.queueing = false;
+        for (size_t i = 0; i < cache.dirty.size(); ++i)
+            cache.queued[cache.dirty[i]] = 0;
+        cache.dirty.clear();
+        bestMoves.clear();
+        tabuMoves.clear();
+    }
+    
+    /**
+     * Finds again the moves of the queued vertices, splitting the scan among
+     * the team when there are enough of them, and files them in the buckets.
+     */
+    void refreshMoves(const Solution& solution, MoveCache& cache,
+            MoveBuckets& bestMoves, MoveBuckets& tabuMoves, const int k)
+    {
+        scanSolution = &solution;
+        scanCache = &cache;
+        scanK = k;
+        if (team.empty() || cache.dirty.size() < MIN_SHARED_SCAN)
+        {
+            scanPart(0, 1);
+        }
+        else
+        {
+            pendingParts.store(team.size(), std::memory_order_relaxed);
+            startGeneration();
+            
+            scanPart(0, team.size() + 1);
+            int spins = 0;
+            while (pendingParts.load(std::memory_order_acquire) != 0)
+            {
+                if (++spins > SPINS_BEFORE_YIELD) std::this_thread::yield();
+            }
+#ifdef TS_COUNTERS
+            for (unsigned int part = 1; part < teamCounters.size(); ++part)
+                mergeCounters(counters, teamCounters[part]);
+#endif
+        }
+        
+        int found = 0;
+        for (size_t i = 0; i < cache.dirty.size(); ++i)
+        {
+            int u = cache.dirty[i];
+            cache.queued[u] = 0;
+            bestMoves.erase(u);
+            tabuMoves.erase(u);
+            if (!cache.valid[u]) continue;
+            ++found;
+            if (cache.bestColor[u] != -1) bestMoves.insert(u, cache.bestDelta[u]);
+            if (cache.tabuColor[u] != -1) tabuMoves.insert(u, cache.tabuDelta[u]);
+        }
+        cache.dirty.clear();
+        TS_COUNT(cachedVertices, conflictingVertices.size() - found);
+    }
+    
+    /**
+     * Takes the best move of the conflicting vertices, drawn among the tied
+     * ones. A tabu move is only taken if it leads to a better solution than
+     * the best one found (aspiration). Few conflicting vertices are scanned;
+     * with many, the best move is looked up in the buckets, and a tabu move
+     * loses ties to non-tabu moves.
+     */
+    void chooseBestMove(const Solution& solution, const int diffToBestValue,
+            MoveCache& cache, MoveBuckets& bestMoves, MoveBuckets& tabuMoves,
+            const int k, ChosenMove& chosen)
+    {
+        size_t numConflicting = conflictingVertices.size();
+        if (!cache.queueing && numConflicting >= MIN_BUCKETED_CONFLICTS)
+            startBuckets(cache, bestMoves, tabuMoves);
+        else if (cache.queueing && numConflicting < MIN_BUCKETED_CONFLICTS / 2)
+            stopBuckets(cache, bestMoves, tabuMoves);
+        if (!cache.queueing)
+        {
+            scanMoves(solution, countAdjColors, conflictingVertices.begin(),
+                    conflictingVertices.end(), diffToBestValue, cache, k,
+                    chosen);
+            return;
+        }
+        
+        refreshMoves(solution, cache, bestMoves, tabuMoves, k);
+        
+        int best = bestMoves.lowestBucket();
+        int tabu = tabuMoves.lowestBucket();
+        bool tabuBetter = tabu != -1
+                && (best == -1 || tabuMoves.delta(tabu) < bestMoves.delta(best));
+        if (tabuBetter && diffToBestValue + tabuMoves.delta(tabu) < 0)
+        {
+            int u = tabuMoves.draw(tabu);
+            chosen.move = std::make_pair(u, cache.tabuColor[u]);
+            chosen.delta = cache.tabuDelta[u];
+            TS_COUNT(aspirationAccepts, 1);
+            return;
+        }
+        if (tabuBetter) TS_COUNT(tabuRejectedMoves, 1);
+        if (best != -1)
+        {
+            int u = bestMoves.draw(best);
+            chosen.move = std::make_pair(u, cache.bestColor[u]);
+            chosen.delta = cache.bestDelta[u];
+        }
+    }
+    
+    long long run(Solution& bestSolution, const int k);
+};
 
+/**
+ * Improves the solution with tabu search using k colors, returning the number
+ * of iterations performed.
+ */
+template <typename Count, int ROW>
+long long TabuKernel<Count, ROW>::run(Solution& bestSolution, const int k)
+{
+    int bestValue = calculateValue(bestSolution);
+    
     Solution currentSolution = bestSolution;
     int currentValue = bestValue;
     int diffToBestValue = 0;
     
-    int maxIt = currentSolution.instance->nvertices * 5000;
-    int it = 0;
-    int lastImprovementIt = 0;
+    long long maxIt = currentSolution.instance->nvertices * 5000LL;
+    long long it = 0;
+    long long lastImprovementIt = 0;
     
     std::list<std::pair<int, int> > tabuList;
+    int n = currentSolution.instance->nvertices;
+    MoveCache cache(n, countAdjColors.length());
+    int maxDegree = ::maxDegree(currentSolution.instance);
+    MoveBuckets bestMoves(n, maxDegree);
+    MoveBuckets tabuMoves(n, maxDegree);
+    
+    // Reactive tenure: revisits of colorings, found through their hashes in
+    // a table of recent ones, lengthen the tenure
+    std::vector<VisitedColoring> visited(VISITED_TABLE_SIZE);
+    for (unsigned int i = 0; i < visited.size(); ++i) visited[i].iteration = -1;
+    double tenureFactor = 1.0;
+    double averageCycleLength = 0.0;
+    
+    // Continue a round saved in a checkpoint, whose best coloring is the
+    // given solution
+    if (resumedRound != NULL)
+    {
+        for (int u = 0; u < currentSolution.instance->nvertices; ++u)
+            currentSolution.coloring[u] = resumedRound->currentColoring[u];
+        reset(currentSolution, k);
+        currentValue = calculateValue(currentSolution);
+        diffToBestValue = currentValue - bestValue;
+        it = resumedRound->iteration;
+        lastImprovementIt = resumedRound->lastImprovementIteration;
+        tenureFactor = resumedRound->tenureFactor;
+        tabuList.assign(resumedRound->tabuList.begin(), resumedRound->tabuList.end());
+        for (std::list<std::pair<int, int> >::iterator tabuIt = tabuList.begin();
+                tabuIt != tabuList.end(); ++tabuIt)
+        {
+            cache.addTabu(*tabuIt);
+        }
+        resumedRound = NULL;
+    }
+
+    unsigned long long hash = hashColoring(currentSolution);
+    long long lastReactionIt = it;
+    
+#ifdef TS_COUNTERS
+    counters = TsCounters();
+#endif
+    trace_event(0, k, bestValue);
     
-    while (it < maxIt || it - lastImprovementIt < maxIt / 10)
+    while ((it < maxIt || it - lastImprovementIt < maxIt / 10)
+            && (iterationLimit == 0 || (it < iterationLimit && bestValue > 0)))
     {
-        std::pair<int, int> bestMove = std::make_pair(-1, -1);
-        int bestMoveDelta = -1;
-        chooseBestMove(currentSolution, countAdjColors, conflictingVertices,
-                diffToBestValue, tabuList, k, bestMove, bestMoveDelta);
+        ChosenMove chosen;
+        chooseBestMove(currentSolution, diffToBestValue, cache, bestMoves,
+                tabuMoves, k, chosen);
+        std::pair<int, int> bestMove = chosen.move;
+        int bestMoveDelta = chosen.delta;
         
         // Append to tabu list and move, if any non-tabu movement was available
         if (bestMove.first != -1)
         {
+            hash ^= zobristKey(bestMove.first, currentSolution.coloring[bestMove.first])
+                    ^ zobristKey(bestMove.first, bestMove.second);
             tabuList.push_back(bestMove);
-            applyMove(currentSolution, countAdjColors, conflictingVertices, bestMove);
+            cache.addTabu(bestMove);
+            moveVertex(currentSolution, countAdjColors, conflictingVertices,
+                    bestMove, &cache);
             currentValue += bestMoveDelta;
+            
+            // Lengthen the tenure on a revisit, and shorten it after a while
+            // without any
+            VisitedColoring& slot = visited[hash & (VISITED_TABLE_SIZE - 1)];
+            if (slot.iteration >= 0 && slot.hash == hash)
+            {
+                TS_COUNT(revisits, 1);
+                averageCycleLength = 0.9 * averageCycleLength
+                        + 0.1 * (it - slot.iteration);
+                tenureFactor = std::min(MAX_TENURE_FACTOR,
+                        tenureFactor * TENURE_INCREASE);
+                lastReactionIt = it;
+            }
+            else if (it - lastReactionIt > MIN_REACTION_INTERVAL + 2 * averageCycleLength)
+            {
+                tenureFactor = std::max(MIN_TENURE_FACTOR,
+                        tenureFactor * TENURE_DECREASE);
+                lastReactionIt = it;
+            }
+            slot.hash = hash;
+            slot.iteration = it;
         }
         
         // Remove least recent tabu
-        unsigned int tabuTenure = (conflictingVertices.size() * k) / 15;
+        unsigned int tabuTenure = (unsigned int) (tenureFactor
+                * ((conflictingVertices.size() * k) / 15));
+        TS_COUNT(conflictingSum, conflictingVertices.size());
+        TS_COUNT_MAX(maxConflicting, (long long) conflictingVertices.size());
+        TS_COUNT(tenureSum, tabuTenure);
         int tabuExcess = tabuList.size() > tabuTenure;
         if (tabuExcess > 0)
         {
             std::list<std::pair<int, int> >::iterator it1, it2;
             it1 = it2 = tabuList.begin();
             std::advance(it2, tabuExcess);
+            for (std::list<std::pair<int, int> >::iterator tabuIt = it1;
+                    tabuIt != it2; ++tabuIt)
+            {
+                cache.removeTabu(*tabuIt);
+            }
             tabuList.erase(it1, it2);
         }
         
@@ -235,9 +1103,11 @@ void tabuSearch(Solution& bestSolution, char** countAdjColors,
         if (currentValue < bestValue)
         {
             lastImprovementIt = it;
+            TS_COUNT(improvements, 1);
             bestSolution = currentSolution;
             bestValue = currentValue;
             diffToBestValue = 0;
+            trace_event(it, k, bestValue);
         }
         else
         {
@@ -246,39 +1116,115 @@ void tabuSearch(Solution& bestSolution, char** countAdjColors,
         
         // Increment iteration
         it += 1;
+        TS_COUNT(iterations, 1);
+        
+        // Save the state at intervals, and before terminating on SIGTERM
+        if (checkpointFeasible != NULL && (terminationRequested
+                || (it % CHECKPOINT_CLOCK_INTERVAL == 0
+                && timing_now() >= nextCheckpointTime)))
+        {
+            saveCheckpoint(currentSolution, bestSolution, tabuList, k, it,
+                    lastImprovementIt, tenureFactor);
+            terminateIfRequested();
+        }
+        
+        // Give up if another island already has a coloring with k colors
+        if (island_poll(it, k)) break;
+#ifdef TS_COUNTERS
+        if (counterDumpInterval > 0 && it % counterDumpInterval == 0)
+            dumpCounters("progress", k, it);
+#endif
     }
+
+#ifdef TS_COUNTERS
+    dumpCounters("round", k, it);
+#endif
+
+    return it;
 }
 
-void ts_constructSolution(Instance* instance, Solution* solution)
+/**
+ * Runs a search of a KColoringSearch on counts of adjacent colors of type
+ * Count.
+ */
+template <typename Count>
+struct GenericSearch
 {
-    // Create first feasible solution using DSATUR heuristic.
-    Solution bestFeasibleSolution(instance);
-    dsatur_constructSolution(instance, &bestFeasibleSolution);
-    int k = bestFeasibleSolution.k();
+    typedef long long (*Search)(Solution& solution,
+            CountTable<Count, 0>& countAdjColors,
+            ConflictList& conflictingVertices, const int k);
     
-    // Setup data structures
-    std::set<int> conflictingVertices;
-    char** countAdjColors = new char*[instance->nvertices];
-    for (int i = 0; i < instance->nvertices; ++i)
+    Search search;
+    CountTable<Count, 0> countAdjColors;
+    ConflictList conflictingVertices;
+    
+    GenericSearch(Search search, int nvertices, int k) :
+        search(search), countAdjColors(nvertices, k),
+        conflictingVertices(nvertices) {}
+    
+    void reset(const Solution& solution, const int k)
     {
-        countAdjColors[i] = new char[k];
-        std::fill(countAdjColors[i], (countAdjColors[i] + k), 0);
+        resetCountAdjColors(solution, countAdjColors, k);
+        resetConflictingVertices(solution, countAdjColors, conflictingVertices);
     }
     
+    long long run(Solution& solution, const int k)
+    {
+        return search(solution, countAdjColors, conflictingVertices, k);
+    }
+};
+
+/**
+ * Lowers k one color at a time: the best feasible solution loses a color
+ * class, and the search tries to remove the conflicts of its vertices. Stops
+ * at the first k for which the search fails. The search was set up for at
+ * least the colors of the given solution.
+ */
+template <typename Search>
+void descendK(Solution& bestFeasibleSolution, Search& search)
+{
+    Instance* instance = bestFeasibleSolution.instance;
+    compactColors(bestFeasibleSolution);
+    int k = bestFeasibleSolution.k();
+    
     bool bestFeasibleSolutionImproving = true;
-    while (bestFeasibleSolutionImproving)
+    while (bestFeasibleSolutionImproving && k > 1)
     {
+        // SIGTERM between rounds leaves only the feasible solution to save
+        if (checkpointFeasible != NULL && terminationRequested)
+        {
+            saveFeasibleCheckpoint();
+            terminateIfRequested();
+        }
+        
+        // Trade the best feasible solution with the other islands, if any
+        island_exchange(bestFeasibleSolution);
+        
         // Get a feasible solution and decrement k by removing one color class
         Solution tabuSolution = bestFeasibleSolution;
-        decrementK(tabuSolution);
-        k = tabuSolution.k();
-
+        if (resumedRound != NULL && resumedRound->k == k - 1)
+        {
+            // Continue the saved round from its best coloring instead
+            for (int u = 0; u < instance->nvertices; ++u)
+                tabuSolution.coloring[u] = resumedRound->bestColoring[u];
+            k = resumedRound->k;
+            tsRandom.state = resumedRound->randomState;
+        }
+        else
+        {
+            resumedRound = NULL;
+            decrementK(tabuSolution);
+            k = tabuSolution.k();
+        }
+        
         // Reset data structures after changing the solution
-        resetCountAdjColors(tabuSolution, countAdjColors, k);
-        resetConflictingVertices(tabuSolution, countAdjColors, conflictingVertices);
+        search.reset(tabuSolution, k);
         
-        // Perform tabu search to improve the current solution
-        tabuSearch(tabuSolution, countAdjColors, conflictingVertices, k);
+        // Search for a k-coloring starting from the current solution
+        PhaseStart round;
+        timing_beginPhase(round);
+        long long iterations = search.run(tabuSolution, k);
+        timing_addRound(k, round, iterations);
         
         // Update best feasible solution, if a new feasible solution was found
         if (tabuSolution.numViolations() == 0)
@@ -287,9 +1233,153 @@ void ts_constructSolution(Instance* instance, Solution* solution)
         }
         else
         {
-            bestFeasibleSolutionImproving = false;
+            // Continue from a better coloring found by another island
+            bestFeasibleSolutionImproving = island_exchange(bestFeasibleSolution);
         }
     }
+}
+
+template <typename Count>
+void descendWithCount(Solution& bestFeasibleSolution, const int k)
+{
+    int n = bestFeasibleSolution.instance->nvertices;
+    if (k <= 16)
+    {
+        TabuKernel<Count, 16> kernel(n, k);
+        descendK(bestFeasibleSolution, kernel);
+    }
+    else if (k <= 64)
+    {
+        TabuKernel<Count, 64> kernel(n, k);
+        descendK(bestFeasibleSolution, kernel);
+    }
+    else if (k <= 256)
+    {
+        TabuKernel<Count, 256> kernel(n, k);
+        descendK(bestFeasibleSolution, kernel);
+    }
+    else
+    {
+        TabuKernel<Count, 0> kernel(n, k);
+        descendK(bestFeasibleSolution, kernel);
+    }
+}
+
+/**
+ * Lowers k with tabu search, using the kernel with the narrowest counts of
+ * adjacent colors that hold the instance's maximum degree and the shortest
+ * rows that hold the starting k. Since k only decreases, the kernel fits the
+ * whole descent.
+ */
+void tabuDescent(Solution& bestFeasibleSolution)
+{
+    Instance* instance = bestFeasibleSolution.instance;
+    compactColors(bestFeasibleSolution);
+    int k = bestFeasibleSolution.k();
+    int maxDegree = ::maxDegree(instance);
+    
+    // The largest count marks the padding of the rows, so degrees stay below
+    if (maxDegree < std::numeric_limits<unsigned char>::max())
+        descendWithCount<unsigned char>(bestFeasibleSolution, k);
+    else if (maxDegree < std::numeric_limits<unsigned short>::max())
+        descendWithCount<unsigned short>(bestFeasibleSolution, k);
+    else
+        descendWithCount<int>(bestFeasibleSolution, k);
+}
+
+/**
+ * Gives the first feasible solution: the saved one, if any, or otherwise the
+ * one of the initial algorithm, DSATUR by default.
+ */
+void createFeasibleSolution(Instance* instance, Solution& solution)
+{
+    if (startCheckpoint != NULL)
+    {
+        for (int u = 0; u < instance->nvertices; ++u)
+            solution.coloring[u] = startCheckpoint->feasibleColoring[u];
+    }
+    else
+    {
+        initialAlgorithm(instance, &solution);
+    }
+}
+
+/**
+ * Lowers k with the search of the given KColoringSearch whose counts of
+ * adjacent colors are the narrowest that hold the instance's maximum degree.
+ */
+void ts_descendK(Instance* instance, Solution* solution,
+        const KColoringSearch& search)
+{
+    Solution bestFeasibleSolution(instance);
+    createFeasibleSolution(instance, bestFeasibleSolution);
+    compactColors(bestFeasibleSolution);
+    int n = instance->nvertices;
+    int k = bestFeasibleSolution.k();
+    int maxDegree = ::maxDegree(instance);
+    if (maxDegree < std::numeric_limits<unsigned char>::max())
+    {
+        GenericSearch<unsigned char> genericSearch(search.narrow, n, k);
+        descendK(bestFeasibleSolution, genericSearch);
+    }
+    else if (maxDegree < std::numeric_limits<unsigned short>::max())
+    {
+        GenericSearch<unsigned short> genericSearch(search.medium, n, k);
+        descendK(bestFeasibleSolution, genericSearch);
+    }
+    else
+    {
+        GenericSearch<int> genericSearch(search.wide, n, k);
+        descendK(bestFeasibleSolution, genericSearch);
+    }
+    
+    for (int u = 0; u < instance->nvertices; ++u)
+    {
+        solution->coloring[u] = bestFeasibleSolution.coloring[u];
+    }
+}
+
+void ts_constructSolution(Instance* instance, Solution* solution)
+{
+    Solution bestFeasibleSolution(instance);
+    createFeasibleSolution(instance, bestFeasibleSolution);
+    
+    // Only tabu search rounds can be saved and continued
+    if (startCheckpoint != NULL && startCheckpoint->k > 0)
+        resumedRound = startCheckpoint;
+    if (!checkpointFileName.empty())
+    {
+        checkpointFeasible = &bestFeasibleSolution;
+        nextCheckpointTime = timing_now() + checkpointInterval;
+        signal(SIGTERM, requestTermination);
+    }
+    tabuDescent(bestFeasibleSolution);
+    if (checkpointFeasible != NULL)
+    {
+        signal(SIGTERM, SIG_DFL);
+        if (terminationRequested) saveFeasibleCheckpoint();
+        terminateIfRequested();
+    }
+    checkpointFeasible = NULL;
+    resumedRound = NULL;
+    
+    for (int u = 0; u < instance->nvertices; ++u)
+    {
+        solution->coloring[u] = bestFeasibleSolution.coloring[u];
+    }
+}
+
+/**
+ * Lowers the number of colors of a feasible solution with tabu search rounds
+ * of at most maxIterations iterations each.
+ */
+void ts_refineSolution(Instance* instance, Solution* solution,
+        long long maxIterations)
+{
+    Solution bestFeasibleSolution = *solution;
+    iterationLimit = maxIterations;
+    tabuDescent(bestFeasibleSolution);
+    iterationLimit = 0;
     
     for (int u = 0; u < instance->nvertices; ++u)
     {
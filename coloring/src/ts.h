@@ -1,8 +1,173 @@
 #ifndef TS_H_
 #define TS_H_
 
+#include <set>
+#include <utility>
+#include <vector>
+
 #include "coloring.h"
+#include "checkpoint.h"
+
+/**
+ * Random number generator of the search (xorshift64*), kept apart from
+ * rand() so that its state can be saved in checkpoints. Each thread has its
+ * own, which other algorithms also draw from, so that threads coloring
+ * components concurrently do not share a state. It is seeded once per
+ * thread: from -s on the main thread, and from a seed drawn beforehand for
+ * each component, batch job and island.
+ */
+struct TsRandom
+{
+    typedef unsigned long long result_type;
+
+    unsigned long long state;
+
+    TsRandom() : state(0x9E3779B97F4A7C15ULL) {}
+
+    void seed(unsigned long long value)
+    {
+        state = (value != 0) ? value : 0x9E3779B97F4A7C15ULL;
+    }
+
+    unsigned long long next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+
+    // Returns a number below n
+    long operator()(long n)
+    {
+        return (long) (next() % (unsigned long long) n);
+    }
+
+    // Returns a number in [0, 1)
+    double uniform()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Makes it usable with std::shuffle
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~0ULL; }
+    result_type operator()() { return next(); }
+};
+extern thread_local TsRandom tsRandom;
+
+/**
+ * Counts of adjacent colors of each vertex, in rows of ROW entries or, when
+ * ROW is 0, of k entries rounded up to a multiple of 16. A row length known
+ * at compile time lets the scans over a row be unrolled and vectorized.
+ * Entries past k hold the largest count, so they are never the best color.
+ */
+template <typename Count, int ROW>
+struct CountTable
+{
+    int rowLength;
+    std::vector<Count> counts;
+    
+    CountTable(int nvertices, int k) :
+        rowLength((ROW > 0) ? ROW : (k + 15) / 16 * 16),
+        counts((size_t) nvertices * rowLength) {}
+    
+    int length() const
+    {
+        return (ROW > 0) ? ROW : rowLength;
+    }
+    
+    Count* operator[](int u)
+    {
+        return &counts[(size_t) u * length()];
+    }
+};
+
+/**
+ * Conflicting vertices in no particular order, with constant time insertion
+ * and removal (by swapping with the last one), so that one can be drawn
+ * uniformly at random.
+ */
+struct ConflictList
+{
+    std::vector<int> vertices;
+    
+    // Index of each vertex in vertices, or -1 if it is not there
+    std::vector<int> position;
+    
+    ConflictList(int nvertices) : position(nvertices, -1) {}
+    
+    size_t size() const
+    {
+        return vertices.size();
+    }
+    
+    int operator[](size_t i) const
+    {
+        return vertices[i];
+    }
+    
+    void insert(int u)
+    {
+        if (position[u] != -1) return;
+        position[u] = vertices.size();
+        vertices.push_back(u);
+    }
+    
+    void erase(int u)
+    {
+        if (position[u] == -1) return;
+        int last = vertices.back();
+        vertices[position[u]] = last;
+        position[last] = position[u];
+        vertices.pop_back();
+        position[u] = -1;
+    }
+    
+    void clear()
+    {
+        for (size_t i = 0; i < vertices.size(); ++i) position[vertices[i]] = -1;
+        vertices.clear();
+    }
+};
+
+/**
+ * Local search for a k-coloring without conflicts. It starts from the given
+ * solution, whose counts of adjacent colors and conflicting vertices are up
+ * to date, leaves there the best solution found and returns the number of
+ * iterations performed. There is a function for each width of the counts,
+ * the narrowest that holds the maximum degree being used.
+ */
+struct KColoringSearch
+{
+    long long (*narrow)(Solution& solution,
+            CountTable<unsigned char, 0>& countAdjColors,
+            ConflictList& conflictingVertices, const int k);
+    long long (*medium)(Solution& solution,
+            CountTable<unsigned short, 0>& countAdjColors,
+            ConflictList& conflictingVertices, const int k);
+    long long (*wide)(Solution& solution, CountTable<int, 0>& countAdjColors,
+            ConflictList& conflictingVertices, const int k);
+};
 
 void ts_constructSolution(Instance* instance, Solution* solution);
+void ts_descendK(Instance* instance, Solution* solution,
+        const KColoringSearch& search);
+void ts_refineSolution(Instance* instance, Solution* solution,
+        long long maxIterations);
+
+void ts_setCounterDumpInterval(int iterations);
+void ts_setScanThreads(int threads);
+void ts_setInitialAlgorithm(ColoringAlgorithm algorithm);
+void ts_setCheckpoint(const char* fileName, double intervalSeconds);
+void ts_setStart(const TsCheckpoint* checkpoint);
+
+// Shared with other searches on the same data structures
+void createFeasibleSolution(Instance* instance, Solution& solution);
+void compactColors(Solution& solution);
+int calculateValue(const Solution& solution);
+template <typename Count>
+void applyMove(Solution& solution, CountTable<Count, 0>& countAdjColors,
+        ConflictList& conflictingVertices, const std::pair<int, int>& move);
 
 #endif /*TS_H_*/
@@ -4,6 +4,7 @@
 #include <ctime>
 
 #include "timetabling.h"
+#include "inputstream.h"
 #include "bb.h"
 #include "rep.h"
 #include "mono.h"
@@ -20,18 +21,26 @@ int main(int argc, char** argv) {
 	}
 	std::string algorithmName(argv[1]);
 	std::string fileName(argv[2]);
+	std::string instanceName = inputstream_stripCompression(fileName);
     
-    std::ifstream in;
-    in.open(fileName.c_str(), std::ifstream::in);
+    // Instances ending in .gz or .zst are decompressed while parsed
+    InputStream in;
+    in.open(fileName);
     Instance instance(in);
+    bool corrupt = in.bad();
     in.close();
+    if (corrupt)
+    {
+        std::cerr << "Invalid or corrupt instance file: " << fileName << std::endl;
+        return 1;
+    }
     
     Solution solution(&instance);
 
     time_t start;
     start = time(NULL);
 
-    std::clog << "instance = " << fileName.substr(0, fileName.size() - 4) << std::endl;
+    std::clog << "instance = " << instanceName.substr(0, instanceName.size() - 4) << std::endl;
 
     try {
         if (algorithmName.compare("bb") == 0)
@@ -71,14 +80,14 @@ int main(int argc, char** argv) {
     
     if (solution.isValid())
     {
-        std::clog << fileName.substr(0, fileName.size() - 4) << "\t"
+        std::clog << instanceName.substr(0, instanceName.size() - 4) << "\t"
         		<< solution.distanceToFeasibility() << "\t"
         		<< solution.softCost() << "\t"
         		<< elapsedTime << std::endl;
     }
     else
     {
-        std::clog << fileName.substr(0, fileName.size() - 4)
+        std::clog << instanceName.substr(0, instanceName.size() - 4)
         		<< " Valid solution not found. " << std::endl;
     }
     